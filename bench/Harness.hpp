@@ -0,0 +1,406 @@
+#pragma once
+#include <rack.hpp>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "../src/noise-plethora/plugins/Banks.hpp"
+
+#if !defined ARCH_WIN
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// the plugin's entry point (plugin.cpp)
+void init(rack::plugin::Plugin* p);
+
+// Shared by the headless developer tools in this folder (see Makefile targets). Sets up just enough
+// of Rack (from the SDK's libRack) to construct and run modules without the GUI, and describes the
+// scripted scenarios (params, inputs, polyphony, module settings) each module is run with.
+
+namespace harness {
+
+using namespace rack;
+
+/** A scripted signal, fed to every channel of an input */
+struct Signal {
+	enum Shape {
+		DC,
+		SINE,
+		SQUARE, 	// 0V to 2 * amplitude, i.e. a gate
+		SAW
+	};
+
+	Shape shape = SINE;
+	float frequency = 110.f; 		// Hz
+	float amplitude = 5.f; 			// V
+	float offset = 0.f; 			// V
+	float channelSpread = 0.f; 		// added per channel (V), e.g. 1/12 for a chromatic cluster
+
+	float at(double time, int channel) const {
+		// detune channels slightly so polyphonic voices aren't identical
+		const double phase = time * frequency * (1.0 + 0.01 * channel);
+		const float p = phase - std::floor(phase);
+		float x = 0.f;
+		switch (shape) {
+			case DC: x = 0.f; break;
+			case SINE: x = amplitude * std::sin(2.0 * M_PI * p); break;
+			case SQUARE: x = (p < 0.5f) ? 2.f * amplitude : 0.f; break;
+			case SAW: x = amplitude * (2.f * p - 1.f); break;
+		}
+		return x + offset + channelSpread * channel;
+	}
+};
+
+struct InputSetting {
+	std::string name; 			// as given to configInput(), or "*" for all inputs
+	int channels = 1;
+	Signal signal;
+};
+
+struct Scenario {
+	std::string slug; 			// Model slug
+	std::string name; 			// short, filename safe, description of the configuration
+	std::string json; 			// optional, passed to dataFromJson() (e.g. to set oversampling)
+	std::vector<std::pair<std::string, float>> params; 	// by name, as given to configParam()
+	std::vector<InputSetting> inputs; 					// inputs not listed are left unpatched
+	// all outputs are patched
+};
+
+/** Initialise Rack headlessly, as in Rack's own headless mode, and load this plugin's models */
+inline plugin::Plugin* init() {
+	settings::devMode = true; 	// log to stderr, use working directory for assets
+	settings::headless = true;
+	system::init();
+	asset::init();
+	logger::init();
+	random::init();
+
+	contextSet(new Context);
+	APP->engine = new engine::Engine;
+
+	plugin::Plugin* p = new plugin::Plugin;
+	::init(p);
+	return p;
+}
+
+inline Model* findModel(plugin::Plugin* p, const std::string& slug) {
+	for (Model* model : p->models) {
+		if (model->slug == slug) {
+			return model;
+		}
+	}
+	return nullptr;
+}
+
+inline void addOversamplingScenarios(std::vector<Scenario>& scenarios, const Scenario& base, int maxOversamplingIndex,
+                                     std::vector<int> channelCounts) {
+	for (int channels : channelCounts) {
+		for (int idx = 0; idx <= maxOversamplingIndex; idx++) {
+			// the FIR filter is only used when oversampling
+			for (int filter = 0; filter < (idx > 0 ? 2 : 1); filter++) {
+				Scenario s = base;
+				s.name = string::f("os%d%s_%dch", 1 << idx, filter ? "fir" : "", channels);
+				s.json = string::f("{\"oversamplingIndex\": %d, \"oversamplingFilter\": %d}", idx, filter);
+				for (InputSetting& input : s.inputs) {
+					input.channels = channels;
+				}
+				scenarios.push_back(s);
+			}
+		}
+	}
+}
+
+/** Scenarios for an oscillator engine (the "oscillatorEngine" JSON setting) that doesn't oversample */
+inline void addEngineScenarios(std::vector<Scenario>& scenarios, const Scenario& base, int engine, const char* name,
+                               std::vector<int> channelCounts) {
+	for (int channels : channelCounts) {
+		Scenario s = base;
+		s.name = string::f("%s_%dch", name, channels);
+		s.json = string::f("{\"oscillatorEngine\": %d}", engine);
+		for (InputSetting& input : s.inputs) {
+			input.channels = channels;
+		}
+		scenarios.push_back(s);
+	}
+}
+
+/** The scenarios for every model; models without a specific set just get all inputs patched (mono and poly) */
+inline std::vector<Scenario> getScenarios(plugin::Plugin* p) {
+	std::vector<Scenario> scenarios;
+
+	{
+		Scenario base;
+		base.slug = "EvenVCO";
+		base.inputs = {{"Pitch 1", 1, {Signal::DC, 0.f, 0.f, 0.f, 1.f / 12.f}}, {"FM", 1, {Signal::SINE, 3.f, 1.f}}};
+		addOversamplingScenarios(scenarios, base, 3, {1, 16});
+		addEngineScenarios(scenarios, base, 1, "polyblep", {1, 16});
+		// sine at x1, square at x8 (outputs are tri, sine, even, saw, square)
+		Scenario s = base;
+		s.name = "os_per_output_1ch";
+		s.json = "{\"outputOversamplingIndex\": [2, 0, 2, 2, 3]}";
+		scenarios.push_back(s);
+	}
+	{
+		Scenario base;
+		base.slug = "PonyVCO";
+		base.params = {{"Timbre", 0.5f}};
+		base.inputs = {{"Volt per octave", 1, {Signal::DC, 0.f, 0.f, 0.f, 1.f / 12.f}}, {"Timber (wavefolder/PWM)", 1, {Signal::SINE, 0.5f, 5.f}}};
+		addOversamplingScenarios(scenarios, base, 3, {1, 16});
+	}
+	{
+		Scenario base;
+		base.slug = "Octaves";
+		base.params = {{"Gain x16 Fundamental", 0.5f}, {"Gain x32 Fundamental", 0.5f}};
+		base.inputs = {{"V/Octave 1", 1, {Signal::DC, 0.f, 0.f, 0.f, 1.f / 12.f}}, {"PWM", 1, {Signal::SINE, 0.5f, 5.f}}};
+		addOversamplingScenarios(scenarios, base, 3, {1, 16});
+		addEngineScenarios(scenarios, base, 1, "polyblep", {1, 16});
+		addEngineScenarios(scenarios, base, 2, "wavetable", {1, 16});
+	}
+	{
+		Scenario base;
+		base.slug = "ChoppingKinky";
+		base.params = {{"Gain/shape control for channel A", 1.f}, {"Gain/shape control for channel B", 1.5f}};
+		base.inputs = {{"A", 1, {Signal::SINE, 110.f}}, {"B", 1, {Signal::SAW, 165.f}}};
+		addOversamplingScenarios(scenarios, base, 4, {1});
+	}
+	{
+		Scenario s;
+		s.slug = "Kickall";
+		s.name = "trigger_4hz";
+		s.inputs = {{"Trigger", 1, {Signal::SQUARE, 4.f}}};
+		scenarios.push_back(s);
+	}
+	{
+		const char* modes[] = {"mono", "stereo", "poly"};
+		for (int mode = 0; mode < 3; mode++) {
+			Scenario s;
+			s.slug = "SpringReverb";
+			s.name = string::f("%s_%dch", modes[mode], mode == 2 ? 16 : 1);
+			s.json = string::f("{\"channelMode\": %d}", mode);
+			s.params = {{"In 1 level", 0.5f}, {"In 2 level", 0.5f}};
+			// (its inputs aren't named)
+			s.inputs = {{"*", mode == 2 ? 16 : 1, {Signal::SAW, 110.f}}};
+			scenarios.push_back(s);
+		}
+	}
+	{
+		// one voice per channel, with the program CV spreading channels over neighbouring programs
+		Scenario s;
+		s.slug = "NoisePlethora";
+		s.name = "poly_8ch";
+		s.json = "{\"algorithmA\": \"radioOhNo\", \"algorithmB\": \"clusterSaw\", \"polyphonic\": true}";
+		s.inputs = {{"XA CV", 8, {Signal::SINE, 0.3f, 5.f}}, {"YB CV", 8, {Signal::SINE, 0.2f, 5.f}},
+			{"Program select A", 8, {Signal::DC, 0.f, 0.f, 0.f, 0.25f}}};
+		scenarios.push_back(s);
+	}
+	{
+		// heavy programs in both sections, rendered ahead on the worker threads
+		Scenario s;
+		s.slug = "NoisePlethora";
+		s.name = "render_ahead";
+		s.json = "{\"algorithmA\": \"WalkingFilomena\", \"algorithmB\": \"satanWorkout\", \"renderAhead\": true}";
+		s.inputs = {{"XA CV", 1, {Signal::SINE, 0.3f, 5.f}}, {"YB CV", 1, {Signal::SINE, 0.2f, 5.f}}};
+		scenarios.push_back(s);
+	}
+	for (int bank = 0; bank < numBanks; bank++) {
+		for (int program = 0; program < getBankForIndex(bank).getSize(); program++) {
+			const std::string programName(getBankForIndex(bank).getProgramName(program));
+			// hardware exact and fast float Teensy primitives, and hardware exact with small blocks
+			const struct {
+				int mode;
+				int blockSize;
+				const char* suffix;
+			} configs[] = {{0, 128, ""}, {1, 128, "_float"}, {0, 16, "_block16"}};
+			for (const auto& config : configs) {
+				Scenario s;
+				s.slug = "NoisePlethora";
+				s.name = string::f("%c%d_%s%s", 'A' + bank, program, programName.c_str(), config.suffix);
+				s.json = string::f("{\"algorithmA\": \"%s\", \"algorithmB\": \"%s\", \"processingMode\": %d, \"blockSize\": %d}",
+				                   programName.c_str(), programName.c_str(), config.mode, config.blockSize);
+				s.inputs = {{"XA CV", 1, {Signal::SINE, 0.3f, 5.f}}, {"YB CV", 1, {Signal::SINE, 0.2f, 5.f}}};
+				scenarios.push_back(s);
+			}
+		}
+	}
+
+	// everything else (plus a generic run of the above) with all inputs patched
+	for (Model* model : p->models) {
+		// needs a MIDI driver
+		if (model->slug == "MidiThing") {
+			continue;
+		}
+		for (int channels : {1, 16}) {
+			Scenario s;
+			s.slug = model->slug;
+			s.name = string::f("all_inputs_%dch", channels);
+			s.inputs = {{"*", channels, {Signal::SINE, 110.f}}};
+			scenarios.push_back(s);
+		}
+	}
+
+	return scenarios;
+}
+
+/** A module instance, patched and configured for a scenario */
+struct Rig {
+	Module* module = nullptr;
+	// input index and its setting, "*" expanded
+	std::vector<std::pair<int, const InputSetting*>> patchedInputs;
+	float sampleRate;
+	int64_t frame = 0;
+
+	Rig(plugin::Plugin* p, const Scenario& scenario, float sampleRate) : sampleRate(sampleRate) {
+		Model* model = findModel(p, scenario.slug);
+		if (!model) {
+			throw Exception("Unknown model %s", scenario.slug.c_str());
+		}
+
+		// modules read the sample rate from the engine on construction
+		APP->engine->setSampleRate(sampleRate);
+		module = model->createModule();
+
+		if (!scenario.json.empty()) {
+			json_error_t error;
+			json_t* rootJ = json_loads(scenario.json.c_str(), 0, &error);
+			if (!rootJ) {
+				throw Exception("Invalid JSON for %s %s: %s", scenario.slug.c_str(), scenario.name.c_str(), error.text);
+			}
+			module->dataFromJson(rootJ);
+			json_decref(rootJ);
+		}
+
+		for (const auto& param : scenario.params) {
+			module->params[findParam(param.first)].setValue(param.second);
+		}
+
+		for (const InputSetting& input : scenario.inputs) {
+			if (input.name == "*") {
+				for (int i = 0; i < (int) module->inputs.size(); i++) {
+					patchedInputs.push_back({i, &input});
+				}
+			}
+			else {
+				patchedInputs.push_back({findInput(input.name), &input});
+			}
+		}
+		// as the engine does when cables are connected
+		for (const auto& input : patchedInputs) {
+			module->inputs[input.first].channels = input.second->channels;
+		}
+		for (Output& output : module->outputs) {
+			output.channels = 1;
+		}
+
+		module->onSampleRateChange();
+	}
+
+	~Rig() {
+		delete module;
+	}
+
+	int findParam(const std::string& name) {
+		for (int i = 0; i < (int) module->paramQuantities.size(); i++) {
+			if (module->paramQuantities[i] && module->paramQuantities[i]->name == name) {
+				return i;
+			}
+		}
+		throw Exception("%s has no param \"%s\"", module->model->slug.c_str(), name.c_str());
+	}
+
+	int findInput(const std::string& name) {
+		for (int i = 0; i < (int) module->inputInfos.size(); i++) {
+			if (module->inputInfos[i] && module->inputInfos[i]->name == name) {
+				return i;
+			}
+		}
+		throw Exception("%s has no input \"%s\"", module->model->slug.c_str(), name.c_str());
+	}
+
+	/** Precomputes the input voltages for the next `numFrames` frames, as [frame][input][channel] */
+	void renderInputs(std::vector<float>& buffer, int numFrames) const {
+		buffer.resize(numFrames * patchedInputs.size() * PORT_MAX_CHANNELS);
+		float* out = buffer.data();
+		for (int n = 0; n < numFrames; n++) {
+			const double time = (frame + n) / (double) sampleRate;
+			for (const auto& input : patchedInputs) {
+				for (int c = 0; c < input.second->channels; c++) {
+					out[c] = input.second->signal.at(time, c);
+				}
+				out += PORT_MAX_CHANNELS;
+			}
+		}
+	}
+
+	/** Runs `numFrames` frames of precomputed inputs through the module, calling `onFrame` after each */
+	template <typename F>
+	void process(const float* inputBuffer, int numFrames, F&& onFrame) {
+		Module::ProcessArgs args;
+		args.sampleRate = sampleRate;
+		args.sampleTime = 1.f / sampleRate;
+
+		for (int n = 0; n < numFrames; n++) {
+			for (const auto& input : patchedInputs) {
+				std::copy_n(inputBuffer, input.second->channels, module->inputs[input.first].voltages);
+				inputBuffer += PORT_MAX_CHANNELS;
+			}
+			args.frame = frame++;
+			module->process(args);
+			onFrame(module);
+		}
+	}
+};
+
+/** Returns the peak resident set size of this process so far, in bytes (or 0 if unknown) */
+inline int64_t getPeakRSS() {
+#if defined ARCH_WIN
+	return 0;
+#else
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+#if defined ARCH_MAC
+	return usage.ru_maxrss;
+#else
+	return usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+/**
+ * Runs `f` in a forked child process, so that each scenario starts from the same (static) state and
+ * peak RSS can be measured per scenario. Returns false if the child failed. On Windows `f` is just
+ * called in process.
+ */
+inline bool runIsolated(const std::function<void()>& f) {
+#if defined ARCH_WIN
+	try {
+		f();
+	}
+	catch (Exception& e) {
+		std::fprintf(stderr, "%s\n", e.what());
+		return false;
+	}
+	return true;
+#else
+	std::fflush(stdout);
+	const pid_t pid = fork();
+	if (pid == 0) {
+		int status = 0;
+		try {
+			f();
+		}
+		catch (Exception& e) {
+			std::fprintf(stderr, "%s\n", e.what());
+			status = 1;
+		}
+		std::fflush(stdout);
+		_exit(status);
+	}
+	int status = 0;
+	waitpid(pid, &status, 0);
+	return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#endif
+}
+
+} // namespace harness
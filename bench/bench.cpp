@@ -0,0 +1,124 @@
+// Headless benchmark of each module's process(), run outside of the Rack GUI against the SDK's libRack.
+//
+//   make bench && build/bench/bench [--filter <text>] [--seconds <s>] [--sample-rate <Hz>] [--csv]
+//
+// Every scenario in Harness.hpp (oversampling settings, polyphony, Noise Plethora programs, ...) is run
+// in its own process, and reports time per sample (i.e. per call to process()), TSC cycles per sample
+// (x86 only), the peak RSS of the process and how much of that was added by the module.
+
+#include "Harness.hpp"
+#include <chrono>
+
+#if defined __x86_64__ || defined __i386__
+#include <x86intrin.h>
+#define BENCH_HAS_TSC 1
+#else
+#define BENCH_HAS_TSC 0
+#endif
+
+using namespace harness;
+
+struct Options {
+	std::string filter;
+	float seconds = 5.f;
+	float sampleRate = 48000.f;
+	bool csv = false;
+};
+
+static void benchmark(plugin::Plugin* p, const Scenario& scenario, const Options& options) {
+	const int64_t rssBefore = getPeakRSS();
+
+	Rig rig(p, scenario, options.sampleRate);
+	const int blockSize = 256;
+	std::vector<float> inputBuffer;
+	auto noop = [](Module*) {};
+
+	// warm up (caches, lazily initialised state, envelopes/filters settling)
+	for (int n = 0; n < options.sampleRate / 2; n += blockSize) {
+		rig.renderInputs(inputBuffer, blockSize);
+		rig.process(inputBuffer.data(), blockSize, noop);
+	}
+
+	const int64_t numFrames = options.seconds * options.sampleRate;
+	double seconds = 0.;
+	uint64_t cycles = 0;
+	for (int64_t n = 0; n < numFrames; n += blockSize) {
+		// signal generation isn't timed
+		rig.renderInputs(inputBuffer, blockSize);
+
+		const auto start = std::chrono::steady_clock::now();
+#if BENCH_HAS_TSC
+		const uint64_t startCycles = __rdtsc();
+#endif
+		rig.process(inputBuffer.data(), blockSize, noop);
+#if BENCH_HAS_TSC
+		cycles += __rdtsc() - startCycles;
+#endif
+		seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	const int64_t framesRun = (numFrames + blockSize - 1) / blockSize * blockSize;
+	const double nsPerSample = 1e9 * seconds / framesRun;
+	const double cyclesPerSample = BENCH_HAS_TSC ? (double) cycles / framesRun : NAN;
+	// how much of the real-time budget at this sample rate one instance takes
+	const double budgetPercent = 100. * nsPerSample * 1e-9 * options.sampleRate;
+	const int64_t rssPeak = getPeakRSS();
+
+	if (options.csv) {
+		std::printf("%s,%s,%.2f,%.1f,%.3f,%lld,%lld\n", scenario.slug.c_str(), scenario.name.c_str(), nsPerSample, cyclesPerSample,
+		            budgetPercent, (long long) rssPeak, (long long)(rssPeak - rssBefore));
+	}
+	else {
+		std::printf("%-16s %-28s %10.2f %10.1f %8.3f%% %10.1f %10.1f\n", scenario.slug.c_str(), scenario.name.c_str(), nsPerSample,
+		            cyclesPerSample, budgetPercent, rssPeak / 1048576., (rssPeak - rssBefore) / 1024.);
+	}
+}
+
+int main(int argc, char* argv[]) {
+	Options options;
+	for (int i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+		if (arg == "--filter" && i + 1 < argc) {
+			options.filter = argv[++i];
+		}
+		else if (arg == "--seconds" && i + 1 < argc) {
+			options.seconds = std::stof(argv[++i]);
+		}
+		else if (arg == "--sample-rate" && i + 1 < argc) {
+			options.sampleRate = std::stof(argv[++i]);
+		}
+		else if (arg == "--csv") {
+			options.csv = true;
+		}
+		else {
+			std::fprintf(stderr, "usage: %s [--filter <text>] [--seconds <s>] [--sample-rate <Hz>] [--csv]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	plugin::Plugin* p = harness::init();
+
+	if (options.csv) {
+		std::printf("module,scenario,ns_per_sample,cycles_per_sample,budget_percent,peak_rss_bytes,module_rss_bytes\n");
+	}
+	else {
+		std::printf("%-16s %-28s %10s %10s %9s %10s %10s\n", "module", "scenario", "ns/sample", "cyc/sample", "budget", "peak MB", "module kB");
+	}
+
+	int failures = 0;
+	for (const Scenario& scenario : getScenarios(p)) {
+		const std::string fullName = scenario.slug + "/" + scenario.name;
+		if (!options.filter.empty() && fullName.find(options.filter) == std::string::npos) {
+			continue;
+		}
+		const bool succeeded = runIsolated([&]() {
+			benchmark(p, scenario, options);
+		});
+		if (!succeeded) {
+			std::fprintf(stderr, "%s failed\n", fullName.c_str());
+			failures++;
+		}
+	}
+
+	return failures ? 1 : 0;
+}
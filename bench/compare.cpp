@@ -0,0 +1,191 @@
+// Compares two directories of renders from render.cpp (golden references vs current), stream by stream:
+//
+//   usage: build/bench/compare <golden dir> <current dir> [--tolerance <V>] [--verbose]
+//
+// Reports the max and RMS error (V), and the largest difference between the (Hann windowed, averaged)
+// magnitude spectra in dB, over bins within 90dB of the golden spectrum's peak. Exits with an error if
+// any render is missing, has a different layout, or has a max error above the tolerance (default 0,
+// i.e. bit exact).
+
+#include <rack.hpp>
+#include <pffft.h>
+#include <map>
+
+using namespace rack;
+
+struct Render {
+	float sampleRate = 0.f;
+	std::vector<std::string> labels;
+	std::vector<float> samples; 	// interleaved, labels.size() streams
+
+	bool load(const std::string& path) {
+		FILE* layoutFile = std::fopen((path + ".txt").c_str(), "r");
+		if (!layoutFile) {
+			return false;
+		}
+		int numStreams = 0;
+		if (std::fscanf(layoutFile, "%f %d\n", &sampleRate, &numStreams) != 2) {
+			std::fclose(layoutFile);
+			return false;
+		}
+		char line[256];
+		while (std::fgets(line, sizeof(line), layoutFile)) {
+			labels.push_back(string::trim(line));
+		}
+		std::fclose(layoutFile);
+		if ((int) labels.size() != numStreams) {
+			return false;
+		}
+
+		FILE* file = std::fopen((path + ".f32").c_str(), "rb");
+		if (!file) {
+			return false;
+		}
+		std::fseek(file, 0, SEEK_END);
+		samples.resize(std::ftell(file) / sizeof(float));
+		std::fseek(file, 0, SEEK_SET);
+		const size_t numRead = std::fread(samples.data(), sizeof(float), samples.size(), file);
+		std::fclose(file);
+		return numRead == samples.size();
+	}
+
+	size_t getNumFrames() const {
+		return labels.empty() ? 0 : samples.size() / labels.size();
+	}
+
+	/** Averaged power spectrum of one stream */
+	std::vector<float> getPowerSpectrum(int stream) const {
+		const int fftSize = 4096;
+		const size_t numFrames = getNumFrames();
+		std::vector<float> power(fftSize / 2 + 1, 0.f);
+		if (numFrames < (size_t) fftSize) {
+			return power;
+		}
+
+		dsp::RealFFT fft(fftSize);
+		float* in = (float*) pffft_aligned_malloc(fftSize * sizeof(float));
+		float* out = (float*) pffft_aligned_malloc(fftSize * sizeof(float));
+		for (size_t start = 0; start + fftSize <= numFrames; start += fftSize / 2) {
+			for (int n = 0; n < fftSize; n++) {
+				const float window = 0.5f * (1.f - std::cos(2.f * M_PI * n / fftSize));
+				in[n] = window * samples[(start + n) * labels.size() + stream];
+			}
+			fft.rfft(in, out);
+			// ordered output: DC and Nyquist (real) first, then interleaved complex bins
+			power[0] += out[0] * out[0];
+			power[fftSize / 2] += out[1] * out[1];
+			for (int k = 1; k < fftSize / 2; k++) {
+				power[k] += out[2 * k] * out[2 * k] + out[2 * k + 1] * out[2 * k + 1];
+			}
+		}
+		pffft_aligned_free(in);
+		pffft_aligned_free(out);
+		return power;
+	}
+};
+
+struct StreamError {
+	double maxError = 0.;
+	double rmsError = 0.;
+	double spectralDifferenceDb = 0.;
+};
+
+static StreamError compareStream(const Render& golden, const Render& current, int stream) {
+	StreamError error;
+	const size_t numStreams = golden.labels.size();
+	const size_t numFrames = golden.getNumFrames();
+	for (size_t n = 0; n < numFrames; n++) {
+		const double difference = (double) current.samples[n * numStreams + stream] - golden.samples[n * numStreams + stream];
+		error.maxError = std::max(error.maxError, std::abs(difference));
+		error.rmsError += difference * difference;
+	}
+	error.rmsError = numFrames ? std::sqrt(error.rmsError / numFrames) : 0.;
+
+	if (error.maxError > 0.) {
+		const std::vector<float> goldenPower = golden.getPowerSpectrum(stream);
+		const std::vector<float> currentPower = current.getPowerSpectrum(stream);
+		const float peakPower = *std::max_element(goldenPower.begin(), goldenPower.end());
+		// ignore bins far below the peak, which are just numerical noise
+		const float floorPower = peakPower * 1e-9f;
+		for (size_t k = 0; k < goldenPower.size(); k++) {
+			if (goldenPower[k] > floorPower) {
+				const double difference = 10. * std::log10((currentPower[k] + 1e-30) / goldenPower[k]);
+				error.spectralDifferenceDb = std::max(error.spectralDifferenceDb, std::abs(difference));
+			}
+		}
+	}
+	return error;
+}
+
+int main(int argc, char* argv[]) {
+	std::vector<std::string> directories;
+	double tolerance = 0.;
+	bool verbose = false;
+	for (int i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+		if (arg == "--tolerance" && i + 1 < argc) {
+			tolerance = std::stod(argv[++i]);
+		}
+		else if (arg == "--verbose") {
+			verbose = true;
+		}
+		else {
+			directories.push_back(arg);
+		}
+	}
+	if (directories.size() != 2) {
+		std::fprintf(stderr, "usage: %s <golden dir> <current dir> [--tolerance <V>] [--verbose]\n", argv[0]);
+		return 1;
+	}
+
+	// sorted, so output is stable
+	std::map<std::string, std::string> renders;
+	for (const std::string& path : system::getEntries(directories[0])) {
+		if (system::getExtension(path) == ".txt") {
+			renders[system::getStem(path)] = path;
+		}
+	}
+
+	std::printf("%-48s %-24s %12s %12s %10s\n", "render", "worst stream", "max error", "rms error", "spectral");
+	int failures = 0;
+	for (const auto& render : renders) {
+		Render golden, current;
+		if (!golden.load(system::join(directories[0], render.first))) {
+			std::printf("%-48s could not load golden render\n", render.first.c_str());
+			failures++;
+			continue;
+		}
+		if (!current.load(system::join(directories[1], render.first))) {
+			std::printf("%-48s missing\n", render.first.c_str());
+			failures++;
+			continue;
+		}
+		if (golden.labels != current.labels || golden.sampleRate != current.sampleRate || golden.getNumFrames() != current.getNumFrames()) {
+			std::printf("%-48s layout differs (outputs, channels, sample rate or length)\n", render.first.c_str());
+			failures++;
+			continue;
+		}
+
+		StreamError worst;
+		std::string worstLabel = "-";
+		for (int stream = 0; stream < (int) golden.labels.size(); stream++) {
+			const StreamError error = compareStream(golden, current, stream);
+			if (verbose) {
+				std::printf("  %-46s %-24s %12.3g %12.3g %8.2fdB\n", "", golden.labels[stream].c_str(), error.maxError, error.rmsError,
+				            error.spectralDifferenceDb);
+			}
+			if (error.maxError > worst.maxError) {
+				worst = error;
+				worstLabel = golden.labels[stream];
+			}
+		}
+
+		const bool failed = worst.maxError > tolerance;
+		failures += failed;
+		std::printf("%-48s %-24s %12.3g %12.3g %8.2fdB%s\n", render.first.c_str(), worstLabel.c_str(), worst.maxError, worst.rmsError,
+		            worst.spectralDifferenceDb, failed ? "  FAIL" : "");
+	}
+
+	std::printf("%d of %d renders differ beyond tolerance (%g V) or are missing\n", failures, (int) renders.size(), tolerance);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,125 @@
+// Headless render of every scenario in Harness.hpp to raw float32 files, to be used as golden references
+// (see compare.cpp), e.g. to check that an optimisation hasn't changed the sound:
+//
+//   build/bench/render golden/          (built from the baseline, i.e. before the change)
+//   build/bench/render current/         (built with the change)
+//   build/bench/compare golden/ current/
+//
+//   usage: build/bench/render <dir> [--filter <text>] [--seconds <s>] [--sample-rate <Hz>]
+//
+// For each scenario, <dir>/<module>_<scenario>.f32 holds the output voltages, interleaved per frame over
+// every channel of every output (channel counts are taken after the first frame), and the matching .txt
+// file gives the sample rate, number of streams and a label for each stream. Rack's random generator is
+// reseeded before each scenario, and each scenario is run in a fresh process, so renders are repeatable.
+
+#include "Harness.hpp"
+
+using namespace harness;
+
+struct Options {
+	std::string directory;
+	std::string filter;
+	float seconds = 2.f;
+	float sampleRate = 48000.f;
+};
+
+static void render(plugin::Plugin* p, const Scenario& scenario, const Options& options) {
+	random::local().seed(0x5eed, 0xbefac0);
+
+	Rig rig(p, scenario, options.sampleRate);
+	const int blockSize = 256;
+	std::vector<float> inputBuffer;
+
+	const std::string path = system::join(options.directory, scenario.slug + "_" + scenario.name);
+	FILE* file = std::fopen((path + ".f32").c_str(), "wb");
+	if (!file) {
+		throw Exception("Could not open %s.f32", path.c_str());
+	}
+
+	// stream layout, fixed after the first frame (when modules have set their output channels)
+	std::vector<std::pair<int, int>> streams;
+	std::vector<float> frameBuffer;
+	auto writeFrame = [&](Module* module) {
+		if (streams.empty()) {
+			for (int i = 0; i < (int) module->outputs.size(); i++) {
+				for (int c = 0; c < module->outputs[i].getChannels(); c++) {
+					streams.push_back({i, c});
+				}
+			}
+			frameBuffer.resize(streams.size());
+		}
+		for (size_t s = 0; s < streams.size(); s++) {
+			frameBuffer[s] = module->outputs[streams[s].first].getVoltage(streams[s].second);
+		}
+		std::fwrite(frameBuffer.data(), sizeof(float), frameBuffer.size(), file);
+	};
+
+	const int64_t numFrames = options.seconds * options.sampleRate;
+	for (int64_t n = 0; n < numFrames; n += blockSize) {
+		const int frames = std::min<int64_t>(blockSize, numFrames - n);
+		rig.renderInputs(inputBuffer, frames);
+		rig.process(inputBuffer.data(), frames, writeFrame);
+	}
+	std::fclose(file);
+
+	FILE* layoutFile = std::fopen((path + ".txt").c_str(), "w");
+	if (!layoutFile) {
+		throw Exception("Could not open %s.txt", path.c_str());
+	}
+	std::fprintf(layoutFile, "%g %d\n", options.sampleRate, (int) streams.size());
+	for (const auto& stream : streams) {
+		const PortInfo* info = rig.module->outputInfos[stream.first];
+		const std::string name = (info && !info->name.empty()) ? info->name : string::f("Output %d", stream.first + 1);
+		std::fprintf(layoutFile, "%s/%d\n", name.c_str(), stream.second + 1);
+	}
+	std::fclose(layoutFile);
+
+	std::printf("%s\n", path.c_str());
+}
+
+int main(int argc, char* argv[]) {
+	Options options;
+	for (int i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+		if (arg == "--filter" && i + 1 < argc) {
+			options.filter = argv[++i];
+		}
+		else if (arg == "--seconds" && i + 1 < argc) {
+			options.seconds = std::stof(argv[++i]);
+		}
+		else if (arg == "--sample-rate" && i + 1 < argc) {
+			options.sampleRate = std::stof(argv[++i]);
+		}
+		else if (options.directory.empty() && arg.substr(0, 2) != "--") {
+			options.directory = arg;
+		}
+		else {
+			options.directory.clear();
+			break;
+		}
+	}
+	if (options.directory.empty()) {
+		std::fprintf(stderr, "usage: %s <dir> [--filter <text>] [--seconds <s>] [--sample-rate <Hz>]\n", argv[0]);
+		return 1;
+	}
+
+	plugin::Plugin* p = harness::init();
+	system::createDirectories(options.directory);
+
+	int failures = 0;
+	for (const Scenario& scenario : getScenarios(p)) {
+		const std::string fullName = scenario.slug + "/" + scenario.name;
+		if (!options.filter.empty() && fullName.find(options.filter) == std::string::npos) {
+			continue;
+		}
+		const bool succeeded = runIsolated([&]() {
+			render(p, scenario, options);
+		});
+		if (!succeeded) {
+			std::fprintf(stderr, "%s failed\n", fullName.c_str());
+			failures++;
+		}
+	}
+
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <rack.hpp>
+
+// Mip-mapped band-limited single cycle tables (saw and triangle): one table per octave of pitch, each with the harmonics
+// that fit below Nyquist at the top of its octave, so waveforms can be read at the base sample rate with no aliasing, and
+// no oversampling or anti-aliasing filters. Reads crossfade between the two octaves' tables either side of the pitch, so
+// the harmonics fade out smoothly as the pitch rises. Pulses (of any width) are the difference of two offset saws.
+namespace wavetable {
+
+struct BandlimitedTables {
+	static const int SIZE_LOG2 = 11;
+	static const int SIZE = 1 << SIZE_LOG2; 		// points per cycle
+	static const int NUM_LEVELS = SIZE_LOG2; 		// level k has harmonics up to SIZE / 2^(k+1)
+
+	// shared by all instances, built on first use
+	static const BandlimitedTables& get() {
+		static const BandlimitedTables tables;
+		return tables;
+	}
+
+	// -1 to +1 over the cycle (as 2 * phase - 1), for a step of deltaPhase (in [0, 0.5]) per sample
+	rack::simd::float_4 saw(rack::simd::float_4 phase, rack::simd::float_4 deltaPhase) const {
+		return read(sawTables, phase, deltaPhase);
+	}
+
+	// -1 at phase 0, +1 at phase 0.5 (as 1 - 2 * |2 * phase - 1|)
+	rack::simd::float_4 tri(rack::simd::float_4 phase, rack::simd::float_4 deltaPhase) const {
+		return read(triTables, phase, deltaPhase);
+	}
+
+private:
+	// with a guard point at the end, for interpolation
+	float sawTables[NUM_LEVELS][SIZE + 1];
+	float triTables[NUM_LEVELS][SIZE + 1];
+
+	BandlimitedTables() {
+		std::vector<float> sine(SIZE);
+		for (int i = 0; i < SIZE; i++) {
+			sine[i] = std::sin(2 * M_PI * i / SIZE);
+		}
+
+		// the Fourier series of the naive waveforms, truncated, with Lanczos sigma factors (which depend on the number of
+		// harmonics, so each level is summed separately) to tame the Gibbs overshoot: the saw's peaks drop from 18% over
+		// full scale to under 2%, and a pulse's (the difference of two saws) from over 30% to a few %
+		std::vector<double> saw(SIZE), tri(SIZE);
+		for (int level = 0; level < NUM_LEVELS; level++) {
+			const int numHarmonics = SIZE >> (level + 1);
+			std::fill(saw.begin(), saw.end(), 0.);
+			std::fill(tri.begin(), tri.end(), 0.);
+			for (int h = 1; h <= numHarmonics; h++) {
+				const double x = M_PI * h / (numHarmonics + 1);
+				const double sigma = std::sin(x) / x;
+				const double sawGain = sigma * -2. / (M_PI * h);
+				const double triGain = (h % 2) ? sigma * -8. / (M_PI * M_PI * h * h) : 0.;
+				for (int i = 0; i < SIZE; i++) {
+					saw[i] += sawGain * sine[(h * i) & (SIZE - 1)];
+					tri[i] += triGain * sine[(h * i + SIZE / 4) & (SIZE - 1)];
+				}
+			}
+
+			for (int i = 0; i <= SIZE; i++) {
+				sawTables[level][i] = saw[i & (SIZE - 1)];
+				triTables[level][i] = tri[i & (SIZE - 1)];
+			}
+		}
+	}
+
+	// level k has the most harmonics that stay below Nyquist for deltaPhase * SIZE in [2^(k-1), 2^k), i.e. it's
+	// floor(log2(deltaPhase * SIZE)) + 1, and is crossfaded into the next level up by how far the pitch is through that
+	// octave (the fractional part of the log, taken linearly from the mantissa, so exact at the octave boundaries).
+	// Pitches below level 0's octave read it unfaded. Level and fade come straight from the float's exponent and
+	// mantissa bits, for the four lanes at once; only the table reads are per lane.
+	static rack::simd::float_4 read(const float (&tables)[NUM_LEVELS][SIZE + 1], rack::simd::float_4 phase, rack::simd::float_4 deltaPhase) {
+		using rack::simd::float_4;
+		using rack::simd::int32_4;
+		const int32_4 bits = int32_4::cast(deltaPhase * SIZE);
+		const float_4 exponent = float_4((bits >> 23) & 0xff) - 126.f; 	// as frexp()'s
+		const float_4 fade = rack::simd::ifelse(exponent < 0.f, 0.f, float_4(bits & 0x7fffff) * (1.f / (1 << 23)));
+		const int32_4 level = int32_4(rack::simd::clamp(exponent, 0.f, NUM_LEVELS - 1.f));
+		const int32_4 next = int32_4(rack::simd::clamp(exponent + 1.f, 1.f, NUM_LEVELS - 1.f));
+
+		const float_4 index = rack::simd::clamp(phase, 0.f, 1.f) * SIZE;
+		const int32_4 i = int32_4(rack::simd::fmin(index, SIZE - 1.f));
+		const float_4 t = index - float_4(i);
+
+		float_4 a, b, c, d;
+		for (int j = 0; j < 4; j++) {
+			const float* table = &tables[level[j]][i[j]];
+			const float* nextTable = &tables[next[j]][i[j]];
+			a[j] = table[0];
+			b[j] = table[1];
+			c[j] = nextTable[0];
+			d[j] = nextTable[1];
+		}
+		const float_4 y = a + (b - a) * t;
+		return y + (c + (d - c) * t - y) * fade;
+	}
+};
+
+} // namespace wavetable
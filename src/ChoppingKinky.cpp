@@ -49,6 +49,7 @@ struct ChoppingKinky : Module {
 
 	chowdsp::VariableOversampling<6> oversampler[NUM_CHANNELS]; 	// uses a 2*6=12th order Butterworth filter
 	int oversamplingIndex = 2; 	// default is 2^oversamplingIndex == x4 oversampling
+	chowdsp::OversamplingChangeFader oversamplingFader; 	// fades outputs while oversampling settings change
 
 	DCBlocker blockDCFilter;
 	bool blockDC = false;
@@ -82,6 +83,7 @@ struct ChoppingKinky : Module {
 
 	void onSampleRateChange() override {
 		float sampleRate = APP->engine->getSampleRate();
+		oversamplingFader.reset(sampleRate);
 
 		blockDCFilter.setFrequency(22.05 / sampleRate);
 
@@ -91,8 +93,22 @@ struct ChoppingKinky : Module {
 		}
 	}
 
+	// called from the context menu: allocates the oversamplers for the new settings here, on the UI thread, then fades
+	// over the change, which the audio thread applies
+	void requestOversamplingChange() {
+		for (int channel_idx = 0; channel_idx < NUM_CHANNELS; channel_idx++) {
+			oversampler[channel_idx].prepare(oversamplingIndex, chowdsp::IIR_FILTER);
+		}
+		oversamplingFader.requestChange();
+	}
+
 	void process(const ProcessArgs& args) override {
 
+		// apply any pending change of oversampling settings, once the outputs have faded out
+		if (oversamplingFader.process()) {
+			onSampleRateChange();
+		}
+
 		float gainA = params[FOLD_A_PARAM].getValue();
 		gainA += params[CV_A_PARAM].getValue() * inputs[CV_A_INPUT].getVoltage() / 10.f;
 		gainA += inputs[VCA_CV_A_INPUT].getVoltage() / 10.f;
@@ -164,9 +180,10 @@ struct ChoppingKinky : Module {
 			outChopp = blockDCFilter.process(outChopp);
 		}
 
-		outputs[OUT_A_OUTPUT].setVoltage(outA);
-		outputs[OUT_B_OUTPUT].setVoltage(outB);
-		outputs[OUT_CHOPP_OUTPUT].setVoltage(outChopp);
+		const float outputGain = oversamplingFader.getGain();
+		outputs[OUT_A_OUTPUT].setVoltage(outputGain * outA);
+		outputs[OUT_B_OUTPUT].setVoltage(outputGain * outB);
+		outputs[OUT_CHOPP_OUTPUT].setVoltage(outputGain * outChopp);
 
 		if (inputs[IN_GATE_INPUT].isConnected()) {
 			lights[LED_A_LIGHT].setSmoothBrightness((float) outputAToChopp, args.sampleTime);
@@ -352,7 +369,7 @@ struct ChoppingKinkyWidget : ModuleWidget {
 		},
 		[ = ](int mode) {
 			module->oversamplingIndex = mode;
-			module->onSampleRateChange();
+			module->requestOversamplingChange();
 		}
 		                                     ));
 	}
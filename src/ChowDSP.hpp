@@ -1,5 +1,8 @@
 #pragma once
 #include <rack.hpp>
+#include <atomic>
+#include <memory>
+#include <tuple>
 
 
 namespace chowdsp {
@@ -64,6 +67,27 @@ struct IIRFilter {
 		return y;
 	}
 
+	/** Processes a buffer in place, keeping the filter state in registers for the whole block */
+	template <int N = ORDER>
+	inline typename std::enable_if <N == 3, void>::type processBlock(T* buffer, int numSamples) noexcept {
+		T z1 = z[1], z2 = z[2];
+		for (int n = 0; n < numSamples; ++n) {
+			const T x = buffer[n];
+			const T y = z1 + x * b[0];
+			z1 = z2 + x * b[1] - y * a[1];
+			z2 = x * b[2] - y * a[2];
+			buffer[n] = y;
+		}
+		z[1] = z1;
+		z[2] = z2;
+	}
+
+	template <int N = ORDER>
+	inline typename std::enable_if <N != 3, void>::type processBlock(T* buffer, int numSamples) noexcept {
+		for (int n = 0; n < numSamples; ++n)
+			buffer[n] = process(buffer[n]);
+	}
+
 	/** Computes the complex transfer function $H(s)$ at a particular frequency
 	s: normalized angular frequency equal to $2 \pi f / f_{sr}$ ($\pi$ is the Nyquist frequency)
 	*/
@@ -265,6 +289,12 @@ public:
 		return x;
 	}
 
+	/** Filters a buffer in place, running each biquad section over the whole buffer in turn */
+	inline void processBlock(T* buffer, int numSamples) noexcept {
+		for (int i = 0; i < N; ++i)
+			filters[i].processBlock(buffer, numSamples);
+	}
+
 private:
 	TBiquadFilter<T> filters[N];
 };
@@ -306,6 +336,10 @@ public:
         oversample.osBuffer[k] = processSample(oversample.osBuffer[k]);
     float y = oversample.downsample();
     @endcode
+
+    Alternatively, whole blocks of base rate samples can be processed with
+    `upsampleBlock()` and `downsampleBlock()`, which run each filter section
+    over the entire oversampled buffer rather than once per sub-sample.
 */
 template<int ratio, int filtN = 4, typename T = float>
 class Oversampling : public BaseOversampling<T> {
@@ -320,21 +354,39 @@ public:
 	}
 
 	inline void upsample(T x) noexcept override {
-		osBuffer[0] = ratio * x;
-		std::fill(&osBuffer[1], &osBuffer[ratio], 0.0f);
-
-		for (int k = 0; k < ratio; k++)
-			osBuffer[k] = aiFilter.process(osBuffer[k]);
+		upsampleBlock(&x, osBuffer, 1);
 	}
 
 	inline T downsample() noexcept override {
-		T y = 0.0f;
-		for (int k = 0; k < ratio; k++)
-			y = aaFilter.process(osBuffer[k]);
-
+		T y;
+		downsampleBlock(osBuffer, &y, 1);
 		return y;
 	}
 
+	/**
+	 * Upsamples `numSamples` base rate samples from `in` into `osOut`,
+	 * which must hold at least `ratio * numSamples` samples.
+	 */
+	inline void upsampleBlock(const T* in, T* osOut, int numSamples) noexcept {
+		for (int n = 0; n < numSamples; n++) {
+			osOut[n * ratio] = ratio * in[n];
+			std::fill(&osOut[n * ratio + 1], &osOut[(n + 1) * ratio], 0.0f);
+		}
+
+		aiFilter.processBlock(osOut, ratio * numSamples);
+	}
+
+	/**
+	 * Downsamples `ratio * numSamples` oversampled samples from `osIn` into `out`.
+	 * Note that `osIn` is used as scratch space, and is anti-alias filtered in place.
+	 */
+	inline void downsampleBlock(T* osIn, T* out, int numSamples) noexcept {
+		aaFilter.processBlock(osIn, ratio * numSamples);
+
+		for (int n = 0; n < numSamples; n++)
+			out[n] = osIn[(n + 1) * ratio - 1];
+	}
+
 	inline T* getOSBuffer() noexcept override {
 		return osBuffer;
 	}
@@ -349,10 +401,231 @@ private:
 typedef Oversampling<1, 4, simd::float_4> OversamplingSIMD;
 
 
+/**
+    Linear phase half-band lowpass FIR (cutoff at 1/4 of the sample rate) in polyphase form,
+    for upsampling or downsampling by a factor of 2.
+
+    A half-band filter of length 4K - 1 has every other coefficient equal to zero (other than the
+    centre tap, which is 0.5), so only K multiplies are needed per base rate sample. For upsampling,
+    the zero-stuffed samples are never computed; for downsampling, only the retained outputs are.
+    Coefficients are designed with a Kaiser windowed sinc.
+
+    The template parameter K is the number of distinct non-zero (symmetric) coefficients.
+*/
+template<int K, typename T = float>
+class HalfBandFilter {
+public:
+	HalfBandFilter(float beta) {
+		design(beta);
+		reset();
+	}
+
+	void reset() {
+		std::fill(evenHistory, &evenHistory[2 * L], 0.0f);
+		std::fill(oddHistory, &oddHistory[L], 0.0f);
+		pos = 0;
+	}
+
+	/** Upsample a single input sample `x` into two output samples */
+	inline void upsample(T x, T* out) noexcept {
+		const T* w = push(evenHistory, x);
+
+		T y = 0.f;
+		for (int k = 1; k <= K; ++k)
+			y += coeffs[k - 1] * (w[K - 1 + k] + w[K - k]);
+
+		out[0] = 2.f * y;
+		out[1] = w[K];
+	}
+
+	/** Downsample two input samples `in[0]`, `in[1]` to a single output sample */
+	inline T downsample(const T* in) noexcept {
+		const T* we = push(evenHistory, in[0]);
+		T y = 0.5f * pushOdd(in[1]);
+		for (int k = 1; k <= K; ++k)
+			y += coeffs[k - 1] * (we[K - 1 + k] + we[K - k]);
+
+		return y;
+	}
+
+private:
+	// history length (in low rate samples) required for a single polyphase branch
+	static constexpr int L = 2 * K;
+
+	void design(float beta) {
+		// windowed sinc, where only odd offsets d from the centre tap are non-zero
+		float sum = 0.f;
+		for (int k = 1; k <= K; ++k) {
+			const int d = 2 * k - 1;
+			const float r = d / (float) (2 * K);
+			const float window = besselI0(beta * std::sqrt(1.f - r * r)) / besselI0(beta);
+			coeffs[k - 1] = ((k % 2) ? 1.f : -1.f) / (M_PI * d) * window;
+			sum += coeffs[k - 1];
+		}
+		// normalise for unity gain at DC (centre tap + both halves)
+		for (int k = 0; k < K; ++k)
+			coeffs[k] *= 0.25f / sum;
+	}
+
+	static float besselI0(float x) {
+		float sum = 1.f, term = 1.f;
+		for (int i = 1; i < 32; ++i) {
+			term *= (x / (2.f * i)) * (x / (2.f * i));
+			sum += term;
+		}
+		return sum;
+	}
+
+	// history is stored twice to avoid wrapping, returns window where w[L - 1] is the newest sample
+	inline const T* push(T* history, T x) noexcept {
+		pos = (pos + 1 == L) ? 0 : pos + 1;
+		history[pos] = history[pos + L] = x;
+		return &history[pos + 1];
+	}
+
+	// the odd branch is just a delay of K samples (the centre tap), so is a plain ring buffer that
+	// shares the write position of the even branch (so must be called after push), returns the delayed sample
+	inline T pushOdd(T x) noexcept {
+		oddHistory[pos] = x;
+		return oddHistory[(pos + K < L) ? pos + K : pos + K - L];
+	}
+
+	float coeffs[K];
+	T evenHistory[2 * L];
+	T oddHistory[L];
+	int pos = 0;
+};
+
+
+/**
+    Oversampling with a cascade of polyphase half-band FIR stages (each 2x), as a cheaper,
+    linear phase alternative to Oversampling (with its high-order IIR filters) at the cost of
+    some extra latency. Usage is identical to Oversampling.
+
+    The first stage (between base rate and 2x) has the steepest transition band, so uses the
+    longest filter; the later stages only need to reject images far from the audio band.
+*/
+template<int ratio, typename T = float>
+class HalfBandOversampling : public BaseOversampling<T> {
+public:
+	HalfBandOversampling() = default;
+	virtual ~HalfBandOversampling() {}
+
+	static_assert(ratio >= 2 && ratio <= 16 && (ratio & (ratio - 1)) == 0, "ratio must be a power of 2 in [2, 16]");
+
+	void reset(float /*baseSampleRate*/) override {
+		upStage0.reset();
+		upStage1.reset();
+		upStage2.reset();
+		upStage3.reset();
+		downStage0.reset();
+		downStage1.reset();
+		downStage2.reset();
+		downStage3.reset();
+		std::fill(osBuffer, &osBuffer[ratio], 0.0f);
+	}
+
+	inline void upsample(T x) noexcept override {
+		upsampleBlock(&x, osBuffer, 1);
+	}
+
+	inline T downsample() noexcept override {
+		T y;
+		downsampleBlock(osBuffer, &y, 1);
+		return y;
+	}
+
+	/** As Oversampling::upsampleBlock */
+	inline void upsampleBlock(const T* in, T* osOut, int numSamples) noexcept {
+		for (int n = 0; n < numSamples; n++) {
+			T* out = &osOut[n * ratio];
+
+			upStage0.upsample(in[n], scratch);
+			upsampleStage(upStage1, scratch, out, 2);
+			upsampleStage(upStage2, out, scratch, 4);
+			upsampleStage(upStage3, scratch, out, 8);
+
+			// scratch holds the final result when ratio is 2 or 8
+			if (ratio == 2 || ratio == 8)
+				std::copy(scratch, &scratch[ratio], out);
+		}
+	}
+
+	/** As Oversampling::downsampleBlock, with `osIn` used as scratch space */
+	inline void downsampleBlock(T* osIn, T* out, int numSamples) noexcept {
+		for (int n = 0; n < numSamples; n++) {
+			T* buffer = &osIn[n * ratio];
+
+			// each stage halves the number of samples, operating in place
+			downsampleStage(downStage3, buffer, 16);
+			downsampleStage(downStage2, buffer, 8);
+			downsampleStage(downStage1, buffer, 4);
+			out[n] = downStage0.downsample(buffer);
+		}
+	}
+
+	inline T* getOSBuffer() noexcept override {
+		return osBuffer;
+	}
+
+	T osBuffer[ratio];
+
+private:
+	// upsamples `len` samples from `in` to `2 * len` samples in `out` (if this stage is active)
+	template<typename S>
+	inline void upsampleStage(S& stage, const T* in, T* out, int len) noexcept {
+		if (ratio <= len)
+			return;
+		for (int i = 0; i < len; ++i)
+			stage.upsample(in[i], &out[2 * i]);
+	}
+
+	// downsamples `len` samples to `len / 2` in place (if this stage is active)
+	template<typename S>
+	inline void downsampleStage(S& stage, T* buffer, int len) noexcept {
+		if (ratio < len)
+			return;
+		for (int i = 0; i < len / 2; ++i)
+			buffer[i] = stage.downsample(&buffer[2 * i]);
+	}
+
+	T scratch[ratio];
+
+	// stands in for the stages beyond `ratio`, which are never run, so hold no filter state
+	struct NoStage {
+		NoStage(float /*beta*/) {}
+		void reset() {}
+		inline void upsample(T /*x*/, T* /*out*/) noexcept {}
+		inline T downsample(const T* /*in*/) noexcept {
+			return 0.f;
+		}
+	};
+
+	// the half-band filter between 2^stage x and 2^(stage + 1) x, if `ratio` needs it (i.e. log2(ratio) stages)
+	template<int stage, int K>
+	using Stage = typename std::conditional < (ratio > (1 << stage)), HalfBandFilter<K, T>, NoStage >::type;
+
+	// Kaiser window beta chosen per stage to give > 65dB stopband attenuation
+	Stage<0, 16> upStage0{7.5f}, downStage0{7.5f}; 	// base rate <-> 2x
+	Stage<1, 6> upStage1{8.f}, downStage1{8.f}; 		// 2x <-> 4x
+	Stage<2, 4> upStage2{8.f}, downStage2{8.f}; 		// 4x <-> 8x
+	Stage<3, 3> upStage3{7.f}, downStage3{7.f}; 		// 8x <-> 16x
+};
+
+
+/** Filters available to VariableOversampling for anti-aliasing/anti-imaging */
+enum OversamplingFilterType {
+	IIR_FILTER, 	// Butterworth IIR (Oversampling), low latency
+	FIR_FILTER, 	// cascaded polyphase half-band FIR (HalfBandOversampling), linear phase, cheaper at high ratios
+	NUM_FILTER_TYPES
+};
+
+
 /**
     Class to implement an oversampled process, with variable
     oversampling factor. To use, create an object, set the oversampling
-    factor using `setOversamplingindex()` and prepare using `reset()`.
+    factor using `setOversamplingindex()` (and optionally the filter type
+    with `setFilterType()`) and prepare using `reset()`.
 
     Then use the following code to process samples:
     @code
@@ -363,17 +636,46 @@ typedef Oversampling<1, 4, simd::float_4> OversamplingSIMD;
     float y = oversample.downsample();
     @endcode
 
+    Only the oversampler for the active factor/filter is held, allocated at its own
+    size. Changing either takes effect at the next `reset()`, which re-initialises
+    the oversampler, so must be called before processing again. So that applying a
+    change on the audio thread doesn't allocate, first call `prepare()` with the new
+    settings from the UI thread. See OversamplingChangeFader for making such changes
+    click-free.
+
 	source (modified): https://github.com/jatinchowdhury18/ChowDSP-VCV/blob/master/src/shared/VariableOversampling.hpp
 */
 template<int filtN = 4, typename T = float>
 class VariableOversampling {
 public:
-	VariableOversampling() = default;
+	VariableOversampling() : active(create(0)) {}
 
-	/** Prepare the oversampler to process audio at a given sample rate */
+	/** Prepare the oversampler to process audio at a given sample rate (applying any new factor or filter type) */
 	void reset(float sampleRate) {
-		for (auto* os : oss)
-			os->reset(sampleRate);
+		updateState();
+		dispatch([sampleRate](auto & os) {
+			os.reset(sampleRate);
+		});
+	}
+
+	/**
+	 * Allocates the oversampler for a factor of 2^idx and filter type ahead of time (on the UI thread), for the
+	 * next `reset()` with those settings to swap in. At most one oversampler is held in reserve like this (or,
+	 * once swapped, the one it replaced, until the next call).
+	 */
+	void prepare(int idx, OversamplingFilterType type) {
+		const size_t index = getStateIndex(idx, type);
+
+		// wait out the audio thread if it's mid-swap
+		int state = spareState.load();
+		while (state == SPARE_BUSY || !spareState.compare_exchange_weak(state, SPARE_BUSY)) {
+			state = spareState.load();
+		}
+		if (!spare || spareIndex != index) {
+			spare.reset(create(index));
+			spareIndex = index;
+		}
+		spareState.store(SPARE_READY);
 	}
 
 	/** Sets the oversampling factor as 2^idx */
@@ -386,19 +688,49 @@ public:
 		return osIdx;
 	}
 
+	/** Sets the type of anti-aliasing/anti-imaging filter used */
+	void setFilterType(OversamplingFilterType newFilterType) {
+		filterType = newFilterType;
+	}
+
+	/** Returns the type of anti-aliasing/anti-imaging filter used */
+	OversamplingFilterType getFilterType() const noexcept {
+		return filterType;
+	}
+
 	/** Upsample a single input sample and update the oversampled buffer */
 	inline void upsample(T x) noexcept {
-		oss[osIdx]->upsample(x);
+		dispatch([x](auto & os) {
+			os.upsample(x);
+		});
 	}
 
 	/** Output a downsampled output sample from the current oversampled buffer */
 	inline T downsample() noexcept {
-		return oss[osIdx]->downsample();
+		return dispatch([](auto & os) {
+			return os.downsample();
+		});
+	}
+
+	/** Upsample a block of input samples into `osOut` (see Oversampling::upsampleBlock) */
+	inline void upsampleBlock(const T* in, T* osOut, int numSamples) noexcept {
+		dispatch([ = ](auto & os) {
+			os.upsampleBlock(in, osOut, numSamples);
+		});
+	}
+
+	/** Downsample a block of oversampled samples into `out` (see Oversampling::downsampleBlock) */
+	inline void downsampleBlock(T* osIn, T* out, int numSamples) noexcept {
+		dispatch([ = ](auto & os) {
+			os.downsampleBlock(osIn, out, numSamples);
+		});
 	}
 
 	/** Returns a pointer to the oversampled buffer */
 	inline T* getOSBuffer() noexcept {
-		return oss[osIdx]->getOSBuffer();
+		return dispatch([](auto & os) {
+			return os.getOSBuffer();
+		});
 	}
 
 	/** Returns the current oversampling factor */
@@ -408,18 +740,147 @@ public:
 
 
 private:
+	// oversamplers are numbered so that IIR_FILTER uses index osIdx, and FIR_FILTER uses index NumOS - 1 + osIdx
+	// (there is no FIR at 1x, as no filtering is needed, so the IIR version is used there)
 	enum {
-		NumOS = 5, // number of oversampling options
+		NumOS = 5,	// number of oversampling options
 	};
 
+	template<size_t index>
+	using StateType = typename std::tuple_element < index, std::tuple <
+	                  Oversampling < 1 << 0, filtN, T >,	// 1x
+	                  Oversampling < 1 << 1, filtN, T >,	// 2x
+	                  Oversampling < 1 << 2, filtN, T >,	// 4x
+	                  Oversampling < 1 << 3, filtN, T >,	// 8x
+	                  Oversampling < 1 << 4, filtN, T >,	// 16x
+	                  HalfBandOversampling < 1 << 1, T >,	// 2x
+	                  HalfBandOversampling < 1 << 2, T >,	// 4x
+	                  HalfBandOversampling < 1 << 3, T >,	// 8x
+	                  HalfBandOversampling < 1 << 4, T >	// 16x
+	                  >>::type;
+
+	static size_t getStateIndex(int idx, OversamplingFilterType type) {
+		return (type == FIR_FILTER && idx > 0) ? NumOS - 1 + idx : idx;
+	}
+
+	static BaseOversampling<T>* create(size_t index) {
+		switch (index) {
+			case 1: return new StateType<1>();
+			case 2: return new StateType<2>();
+			case 3: return new StateType<3>();
+			case 4: return new StateType<4>();
+			case 5: return new StateType<5>();
+			case 6: return new StateType<6>();
+			case 7: return new StateType<7>();
+			case 8: return new StateType<8>();
+			default: return new StateType<0>();
+		}
+	}
+
+	// switch to the oversampler for the current factor and filter type, if it's changed: the one made by prepare() if
+	// it matches (so without allocating), otherwise a new one
+	void updateState() {
+		const size_t newIndex = getStateIndex(osIdx, filterType);
+		if (newIndex == activeIndex) {
+			return;
+		}
+
+		int state = SPARE_READY;
+		if (spareState.compare_exchange_strong(state, SPARE_BUSY)) {
+			const bool matches = (spareIndex == newIndex);
+			if (matches) {
+				std::swap(active, spare);
+				std::swap(activeIndex, spareIndex);
+			}
+			spareState.store(matches ? SPARE_RETIRED : SPARE_READY);
+			if (matches) {
+				return;
+			}
+		}
+
+		// not prepared (e.g. on construction, or loading a patch)
+		active.reset(create(newIndex));
+		activeIndex = newIndex;
+	}
+
+	// calls f on the active oversampler, resolved statically so that calls can be inlined
+	template <typename F>
+	inline auto dispatch(F&& f) noexcept {
+		switch (activeIndex) {
+			case 1: return f(static_cast<StateType<1>&>(*active));
+			case 2: return f(static_cast<StateType<2>&>(*active));
+			case 3: return f(static_cast<StateType<3>&>(*active));
+			case 4: return f(static_cast<StateType<4>&>(*active));
+			case 5: return f(static_cast<StateType<5>&>(*active));
+			case 6: return f(static_cast<StateType<6>&>(*active));
+			case 7: return f(static_cast<StateType<7>&>(*active));
+			case 8: return f(static_cast<StateType<8>&>(*active));
+			default: return f(static_cast<StateType<0>&>(*active));
+		}
+	}
+
 	int osIdx = 0;
+	OversamplingFilterType filterType = IIR_FILTER;
+	std::unique_ptr<BaseOversampling<T>> active;
+	size_t activeIndex = 0;
+
+	// handed between prepare() (UI thread) and updateState() (audio thread), whichever sets SPARE_BUSY owns it
+	enum SpareState {
+		SPARE_EMPTY,
+		SPARE_BUSY,
+		SPARE_READY, 	// prepared, to be swapped in
+		SPARE_RETIRED 	// swapped out, to be replaced or reused by the next prepare()
+	};
+	std::unique_ptr<BaseOversampling<T>> spare;
+	size_t spareIndex = 0;
+	std::atomic<int> spareState{SPARE_EMPTY};
+};
+
+
+/**
+ * Fades a module's outputs to silence before its oversamplers are re-initialised (e.g. when the
+ * oversampling factor is changed from the context menu), and back up afterwards, so the change
+ * doesn't click. The old oversamplers keep running during the fade out, so the new ones are never
+ * run alongside them (and can be allocated ahead with VariableOversampling::prepare()).
+ *
+ * Call requestChange() from the UI thread. Call process() once per sample from the audio thread: it
+ * returns true at the point the module should re-initialise its oversamplers (i.e. call
+ * onSampleRateChange()), and getGain() is the gain to apply to the module's outputs.
+ */
+class OversamplingChangeFader {
+public:
+	void reset(float sampleRate) {
+		delta = 1.f / std::max(1.f, fadeTime * sampleRate);
+	}
 
-	Oversampling < 1 << 0, filtN, T > os0; // 1x
-	Oversampling < 1 << 1, filtN, T > os1; // 2x
-	Oversampling < 1 << 2, filtN, T > os2; // 4x
-	Oversampling < 1 << 3, filtN, T > os3; // 8x
-	Oversampling < 1 << 4, filtN, T > os4; // 16x
-	BaseOversampling<T>* oss[NumOS] = { &os0, &os1, &os2, &os3, &os4 };
+	void requestChange() {
+		changeRequested.store(true);
+	}
+
+	bool process() {
+		if (changeRequested.load(std::memory_order_relaxed)) {
+			gain -= delta;
+			// (a request made since is kept, and fades again)
+			if (gain <= 0.f && changeRequested.exchange(false)) {
+				gain = 0.f;
+				return true;
+			}
+		}
+		else if (gain < 1.f) {
+			gain = std::min(gain + delta, 1.f);
+		}
+		return false;
+	}
+
+	float getGain() const {
+		return gain;
+	}
+
+private:
+	static constexpr float fadeTime = 0.005f; 	// seconds, for each of fade out and fade in
+	float delta = 1.f;
+	float gain = 1.f;
+	std::atomic<bool> changeRequested{false}; 	// set on the UI thread, cleared on the audio thread
 };
 
 } // namespace chowdsp
@@ -0,0 +1,86 @@
+#pragma once
+#include <rack.hpp>
+
+// Differentiated polynomial waveforms, from "Alias-Suppressed Oscillators Based on Differentiated Polynomial
+// Waveforms" (Välimäki et al.), also see the notes in the Surge Synthesizer repo:
+// https://github.com/surge-synthesizer/surge/blob/09f1ec8e103265bef6fc0d8a0fc188238197bf8c/src/common/dsp/oscillators/ModernOscillator.cpp#L19
+//
+// Each waveform is the second finite difference of a polynomial of the phase (scaled by 1 / (4 * deltaPhase^2)).
+namespace dpw {
+
+template <typename T>
+T saw(T phase) {
+	const T p = 2 * phase - 1.0; 		// range -1 to +1
+	return (p * p * p - p) / 6.0;		// eq 11
+}
+
+template <typename T>
+T tri(T phase) {
+	const T p = 2 * phase - 1.0; 		// range -1.0 to +1.0
+	const T s = 0.5 - rack::simd::abs(p); 	// eq 30
+	return (s * s * s - 0.75 * s) / 3.0; 	// eq 29
+}
+
+// saw at twice the frequency
+template <typename T>
+T doubleSaw(T phase) {
+	const T p = 4.0 * rack::simd::ifelse(phase < 0.5, phase, phase - 0.5) - 1.0;
+	return (p * p * p - p) / 24.0;		// eq 11 (modified for doubled freq)
+}
+
+// saw offset by the pulse width (pw in [0, 1]), for pulses as the difference of two saws
+template <typename T>
+T offsetSaw(T phase, T pw) {
+	const T p = 2 * phase - 1.0; 		// range -1 to +1
+	T pwp = p + 2 * pw;					// phase after pw
+	pwp += rack::simd::ifelse(pwp > 1, -2, 0); 	// modulo on [-1, +1]
+	return (pwp * pwp * pwp - pwp) / 6.0;	// eq 11
+}
+
+/**
+ * The polynomial's values at the previous two (oversampled) steps, so that each step only evaluates it at the
+ * newest phase, rather than at all three.
+ *
+ * Where the history can't be trusted (after hard sync, a change of frequency or of the polynomial itself, or when
+ * it hasn't been kept up to date) extrapolate() replaces it with the polynomial at the phases one and two steps
+ * back at the current rate, i.e. the second difference is taken as if the frequency had always been the current one.
+ */
+template <typename T>
+struct History {
+	T values[2] = {}; 	// oldest first
+	bool stale = true; 	// not kept up to date, so to be extrapolated everywhere
+
+	// where `mask` is set (or everywhere if stale), the polynomial at the two steps before `phase` (in [0, 1])
+	template <typename Polynomial>
+	void extrapolate(T mask, T phase, T deltaPhase, Polynomial polynomial) {
+		if (stale) {
+			mask = T::mask();
+			stale = false;
+		}
+		else if (rack::simd::movemask(mask) == 0) {
+			return;
+		}
+		const T phase2 = phase - 2 * deltaPhase + rack::simd::ifelse(phase < 2 * deltaPhase, 1.f, 0.f);
+		const T phase1 = phase - deltaPhase + rack::simd::ifelse(phase < deltaPhase, 1.f, 0.f);
+		values[0] = rack::simd::ifelse(mask, polynomial(phase2), values[0]);
+		values[1] = rack::simd::ifelse(mask, polynomial(phase1), values[1]);
+	}
+
+	// the second difference, given the polynomial at the newest phase
+	T process(T value) {
+		const T difference = values[0] - 2.0 * values[1] + value;
+		values[0] = values[1];
+		values[1] = value;
+		return difference;
+	}
+};
+
+// whether the history taken at `previousDeltaPhase` still holds at `deltaPhase`: as the second difference is scaled
+// by 1 / (4 * deltaPhase^2), a change in step size adds an error of up to about |change| / (12 * deltaPhase^2), kept
+// here well under the 24 bit resolution of a float
+template <typename T>
+T isRateChanged(T deltaPhase, T previousDeltaPhase) {
+	return rack::simd::abs(deltaPhase - previousDeltaPhase) > 1e-6f * deltaPhase * deltaPhase;
+}
+
+} // namespace dpw
@@ -1,5 +1,7 @@
 #include "plugin.hpp"
 #include "ChowDSP.hpp"
+#include "DPW.hpp"
+#include "PolyBLEP.hpp"
 
 using simd::float_4;
 
@@ -30,6 +32,12 @@ struct EvenVCO : Module {
 
 	float_4 phase[4] = {};
 	dsp::TSchmittTrigger<float_4> syncTrigger[4];
+	// DPW polynomials at the previous two steps (the square is the difference of a saw and the offset saw, its saw being
+	// the saw output's when they run at the same rate)
+	dpw::History<float_4> sawHistory[4], squareSawHistory[4], offsetSawHistory[4], triHistory[4], doubleSawHistory[4];
+	// the step size (at each output's rate) and pulse width the histories were taken at
+	float_4 previousDeltaPhase[NUM_OUTPUTS][4] = {};
+	float_4 previousPW[4] = {};
 	bool removePulseDC = true;
 	bool limitPW = true;
 
@@ -58,69 +66,130 @@ struct EvenVCO : Module {
 
 	void onSampleRateChange() override {
 		float sampleRate = APP->engine->getSampleRate();
+		oversamplingFader.reset(sampleRate);
+		activeEngine = oscillatorEngine;
 		for (int i = 0; i < NUM_OUTPUTS; ++i) {
 			for (int c = 0; c < 4; c++) {
-				oversampler[i][c].setOversamplingIndex(oversamplingIndex);
+				// polyBLEP runs at the base rate, whatever the oversampling settings
+				oversampler[i][c].setOversamplingIndex(activeEngine == POLYBLEP_ENGINE ? 0 : oversamplingIndex[i]);
+				oversampler[i][c].setFilterType(oversamplingFilter);
 				oversampler[i][c].reset(sampleRate);
 			}
 		}
-
-		const float lowFreqRegime = oversampler[0][0].getOversamplingRatio() * 1e-3 * sampleRate;
-		DEBUG("Low freq regime: %g", lowFreqRegime);
 	}
 
-	float_4 aliasSuppressedTri(float_4* phases) {
-		float_4 triBuffer[3];
-		for (int i = 0; i < 3; ++i) {
-			float_4 p = 2 * phases[i] - 1.0; 				// range -1.0 to +1.0
-			float_4 s = 0.5 - simd::abs(p); 				// eq 30
-			triBuffer[i] = (s * s * s - 0.75 * s) / 3.0; 	// eq 29
+	// from the context menu: prepares each output's oversamplers off the audio thread, then fades over the change
+	void requestOversamplingChange() {
+		for (int i = 0; i < NUM_OUTPUTS; ++i) {
+			for (int c = 0; c < 4; c++) {
+				oversampler[i][c].prepare(oscillatorEngine == POLYBLEP_ENGINE ? 0 : oversamplingIndex[i], oversamplingFilter);
+			}
 		}
-		return (triBuffer[0] - 2.0 * triBuffer[1] + triBuffer[2]);
+		oversamplingFader.requestChange();
 	}
 
-	float_4 aliasSuppressedSaw(float_4* phases) {
-		float_4 sawBuffer[3];
-		for (int i = 0; i < 3; ++i) {
-			float_4 p = 2 * phases[i] - 1.0; 		// range -1 to +1
-			sawBuffer[i] = (p * p * p - p) / 6.0;	// eq 11
-		}
+	chowdsp::VariableOversampling<6, float_4> oversampler[NUM_OUTPUTS][4]; 	// uses a 2*6=12th order Butterworth filter
+	// per output, default is 2^oversamplingIndex == x4 oversampling (the sine has no aliasing to suppress, so can run at x1)
+	int oversamplingIndex[NUM_OUTPUTS] = {2, 2, 2, 2, 2};
+	chowdsp::OversamplingChangeFader oversamplingFader; 	// fades outputs while oversampling settings change
+	chowdsp::OversamplingFilterType oversamplingFilter = chowdsp::IIR_FILTER; 	// low latency IIR or linear phase FIR
+
+	enum OscillatorEngine {
+		DPW_ENGINE, 		// differentiated polynomial waveforms, oversampled
+		POLYBLEP_ENGINE, 	// naive waveforms with polyBLEP / polyBLAMP residuals, at the base sample rate
+		NUM_ENGINES
+	};
+	OscillatorEngine oscillatorEngine = DPW_ENGINE;
+	OscillatorEngine activeEngine = DPW_ENGINE; 	// changes with the oversampling settings, i.e. once faded out
+
+	static const int MAX_OVERSAMPLING_INDEX = 3;
+	static const int MAX_OVERSAMPLING_RATIO = 1 << MAX_OVERSAMPLING_INDEX;
+
+	// one sample's worth of oversampled steps for a group of four channels, as passed to the kernels
+	struct Steps {
+		int group;
+		int numSteps; 				// at the highest oversampling ratio of the outputs computed
+		const float_4* phases; 		// phase after each step, in [0, 1]
+		float_4 deltaPhase; 		// per step
+		float_4 syncMask;
+		float_4 pw;
+		float_4 pulseDCOffset;
+	};
 
-		return (sawBuffer[0] - 2.0 * sawBuffer[1] + sawBuffer[2]);
-	}
+	// renders one or more outputs' oversampled buffers
+	typedef void (EvenVCO::*Kernel)(const Steps& steps);
+
+	// the kernels for the connected outputs (each at its own oversampling ratio), worked out whenever connections or
+	// oversampling settings change, so nothing in the oversampling loops depends on them
+	struct Plan {
+		int key = -1; 	// connected outputs and oversampling indices planned for
+		Kernel kernels[NUM_OUTPUTS];
+		int numKernels = 0;
+		int ratio = 1; 	// steps per sample
+		bool usesHistory[5] = {}; 	// tri, saw, square's saw, offset saw, double saw
+	};
+	Plan plan;
 
-	float_4 aliasSuppressedDoubleSaw(float_4* phases) {
-		float_4 sawBuffer[3];
-		for (int i = 0; i < 3; ++i) {
-			float_4 p = 4.0 * simd::ifelse(phases[i] < 0.5,  phases[i], phases[i] - 0.5) - 1.0;
-			sawBuffer[i] = (p * p * p - p) / 24.0;	// eq 11 (modified for doubled freq)
+	void updatePlan() {
+		int key = activeEngine;
+		for (int i = 0; i < NUM_OUTPUTS; i++) {
+			key = (key << 3) | (outputs[i].isConnected() << 2) | oversampler[i][0].getOversamplingIndex();
+		}
+		if (key == plan.key) {
+			return;
 		}
 
-		return (sawBuffer[0] - 2.0 * sawBuffer[1] + sawBuffer[2]);
-	}
-
-	float_4 aliasSuppressedOffsetSaw(float_4* phases, float_4 pw) {
-		float_4 sawOffsetBuff[3];
-
-		for (int i = 0; i < 3; ++i) {
-			float_4 p = 2 * phases[i] - 1.0; 	// range -1 to +1
-			float_4 pwp = p + 2 * pw;			// phase after pw (pw in [0, 1])
-			pwp += simd::ifelse(pwp > 1, -2, 0);     			// modulo on [-1, +1]
-			sawOffsetBuff[i] = (pwp * pwp * pwp - pwp) / 6.0;	// eq 11
+		plan = Plan();
+		plan.key = key;
+		auto add = [this](int output, Kernel kernel) {
+			if (outputs[output].isConnected()) {
+				plan.kernels[plan.numKernels++] = kernel;
+				plan.ratio = std::max(plan.ratio, oversampler[output][0].getOversamplingRatio());
+			}
+		};
+		add(SINE_OUTPUT, &EvenVCO::renderSine);
+		if (activeEngine == POLYBLEP_ENGINE) {
+			// (no DPW histories used)
+			add(TRI_OUTPUT, &EvenVCO::renderTriBLEP);
+			add(EVEN_OUTPUT, &EvenVCO::renderEvenBLEP);
+			add(SAW_OUTPUT, &EvenVCO::renderSawBLEP);
+			add(SQUARE_OUTPUT, &EvenVCO::renderSquareBLEP);
+			return;
+		}
+		add(TRI_OUTPUT, &EvenVCO::renderTri);
+		add(EVEN_OUTPUT, &EvenVCO::renderEven);
+		// saw and square share the saw polynomial when they can
+		const bool sharedSaw = outputs[SAW_OUTPUT].isConnected() && outputs[SQUARE_OUTPUT].isConnected()
+		                       && oversampler[SAW_OUTPUT][0].getOversamplingIndex() == oversampler[SQUARE_OUTPUT][0].getOversamplingIndex();
+		if (sharedSaw) {
+			add(SAW_OUTPUT, &EvenVCO::renderSawAndSquare);
+		}
+		else {
+			add(SAW_OUTPUT, &EvenVCO::renderSaw);
+			add(SQUARE_OUTPUT, &EvenVCO::renderSquare);
 		}
-		return (sawOffsetBuff[0] - 2.0 * sawOffsetBuff[1] + sawOffsetBuff[2]);
-	}
 
-	chowdsp::VariableOversampling<6, float_4> oversampler[NUM_OUTPUTS][4]; 	// uses a 2*6=12th order Butterworth filter
-	int oversamplingIndex = 2; 	// default is 2^oversamplingIndex == x4 oversampling
+		plan.usesHistory[0] = outputs[TRI_OUTPUT].isConnected();
+		plan.usesHistory[1] = outputs[SAW_OUTPUT].isConnected();
+		plan.usesHistory[2] = outputs[SQUARE_OUTPUT].isConnected() && !sharedSaw;
+		plan.usesHistory[3] = outputs[SQUARE_OUTPUT].isConnected();
+		plan.usesHistory[4] = outputs[EVEN_OUTPUT].isConnected();
+	}
 
 	void process(const ProcessArgs& args) override {
 
 		// pitch inputs determine number of polyphony engines
 		const int channels = std::max({1, inputs[PITCH1_INPUT].getChannels(), inputs[PITCH2_INPUT].getChannels()});
 
+		// apply any pending change of oversampling settings, once the outputs have faded out
+		if (oversamplingFader.process()) {
+			onSampleRateChange();
+		}
+		const float outputGain = 5.f * oversamplingFader.getGain();
+
+		updatePlan();
+
 		const float pitchKnobs = 1.f + std::round(params[OCTAVE_PARAM].getValue()) + params[TUNE_PARAM].getValue() / 12.f;
-		const int oversamplingRatio = oversampler[0][0].getOversamplingRatio();
 
 		for (int c = 0; c < channels; c += 4) {
 			float_4 pw = simd::clamp(params[PWM_PARAM].getValue() + inputs[PWM_INPUT].getPolyVoltageSimd<float_4>(c) / 5.f, -1.f, 1.f);
@@ -134,13 +203,7 @@ struct EvenVCO : Module {
 			const float_4 fmVoltage = inputs[FM_INPUT].getPolyVoltageSimd<float_4>(c) * 0.25f;
 			const float_4 pitch = inputs[PITCH1_INPUT].getPolyVoltageSimd<float_4>(c) + inputs[PITCH2_INPUT].getPolyVoltageSimd<float_4>(c);
 			const float_4 freq = dsp::FREQ_C4 * simd::pow(2.f, pitchKnobs + pitch + fmVoltage);
-			const float_4 deltaBasePhase = simd::clamp(freq * args.sampleTime / oversamplingRatio, 1e-6, 0.5f);
-			// floating point arithmetic doesn't work well at low frequencies, specifically because the finite difference denominator
-			// becomes tiny - we check for that scenario and use naive / 1st order waveforms in that frequency regime (as aliasing isn't
-			// a problem there). With no oversampling, at 44100Hz, the threshold frequency is 44.1Hz.
-			const float_4 lowFreqRegime = simd::abs(deltaBasePhase) < 1e-3;
-			// 1 / denominator for the second-order FD
-			const float_4 denominatorInv = 0.25 / (deltaBasePhase * deltaBasePhase);
+			const float_4 deltaBasePhase = simd::clamp(freq * args.sampleTime / plan.ratio, 1e-6, 0.5f);
 
 			// pulsewave waveform doesn't have DC even for non 50% duty cycles, but Befaco team would like the option
 			// for it to be added back in for hardware compatibility reasons
@@ -150,107 +213,240 @@ struct EvenVCO : Module {
 			const float_4 syncMask = syncTrigger[c / 4].process(inputs[SYNC_INPUT].getPolyVoltageSimd<float_4>(c));
 			phase[c / 4] = simd::ifelse(syncMask, 0.5f, phase[c / 4]);
 
-			float_4* osBufferTri = oversampler[TRI_OUTPUT][c / 4].getOSBuffer();
-			float_4* osBufferSaw = oversampler[SAW_OUTPUT][c / 4].getOSBuffer();
-			float_4* osBufferSin = oversampler[SINE_OUTPUT][c / 4].getOSBuffer();
-			float_4* osBufferSquare = oversampler[SQUARE_OUTPUT][c / 4].getOSBuffer();
-			float_4* osBufferEven = oversampler[EVEN_OUTPUT][c / 4].getOSBuffer();
-			for (int i = 0; i < oversamplingRatio; ++i) {
-
+			// the phase at each step at the highest rate, outputs at lower rates take every 2nd, 4th, ... step
+			float_4 phases[MAX_OVERSAMPLING_RATIO];
+			for (int i = 0; i < plan.ratio; ++i) {
 				phase[c / 4] += deltaBasePhase;
 				// ensure within [0, 1]
 				phase[c / 4] -= simd::floor(phase[c / 4]);
+				phases[i] = phase[c / 4];
+			}
 
-				float_4 phases[3]; // phase as extrapolated to the current and two previous samples
+			// the DPW histories of waveforms not computed go stale
+			triHistory[c / 4].stale |= !plan.usesHistory[0];
+			sawHistory[c / 4].stale |= !plan.usesHistory[1];
+			squareSawHistory[c / 4].stale |= !plan.usesHistory[2];
+			offsetSawHistory[c / 4].stale |= !plan.usesHistory[3];
+			doubleSawHistory[c / 4].stale |= !plan.usesHistory[4];
 
-				phases[0] = phase[c / 4] - 2 * deltaBasePhase + simd::ifelse(phase[c / 4] < 2 * deltaBasePhase, 1.f, 0.f);
-				phases[1] = phase[c / 4] - deltaBasePhase + simd::ifelse(phase[c / 4] < deltaBasePhase, 1.f, 0.f);
-				phases[2] = phase[c / 4];
+			const Steps steps = {c / 4, plan.ratio, phases, deltaBasePhase, syncMask, pw, pulseDCOffset};
+			for (int k = 0; k < plan.numKernels; k++) {
+				(this->*plan.kernels[k])(steps);
+			}
+			previousPW[c / 4] = pw;
 
-				if (outputs[SINE_OUTPUT].isConnected() || outputs[EVEN_OUTPUT].isConnected()) {
-					// sin doesn't need PDW
-					osBufferSin[i] = -simd::cos(2.0 * M_PI * phase[c / 4]);
+			// downsample (if required)
+			for (int output = 0; output < NUM_OUTPUTS; output++) {
+				if (outputs[output].isConnected()) {
+					chowdsp::VariableOversampling<6, float_4>& os = oversampler[output][c / 4];
+					const float_4 out = (os.getOversamplingRatio() > 1) ? os.downsample() : os.getOSBuffer()[0];
+					outputs[output].setVoltageSimd(outputGain * out, c);
 				}
+			}
 
-				if (outputs[TRI_OUTPUT].isConnected()) {
-					const float_4 dpwOrder1 = 1.0 - 2.0 * simd::abs(2 * phase[c / 4] - 1.0);
-					const float_4 dpwOrder3 = aliasSuppressedTri(phases) * denominatorInv;
-
-					osBufferTri[i] = simd::ifelse(lowFreqRegime, dpwOrder1, dpwOrder3);
-				}
+		} 	// end of channels loop
 
-				if (outputs[SAW_OUTPUT].isConnected()) {
-					const float_4 dpwOrder1 = 2 * phase[c / 4] - 1.0;
-					const float_4 dpwOrder3 = aliasSuppressedSaw(phases) * denominatorInv;
+		// Outputs
+		outputs[TRI_OUTPUT].setChannels(channels);
+		outputs[SINE_OUTPUT].setChannels(channels);
+		outputs[EVEN_OUTPUT].setChannels(channels);
+		outputs[SAW_OUTPUT].setChannels(channels);
+		outputs[SQUARE_OUTPUT].setChannels(channels);
+	}
 
-					osBufferSaw[i] = simd::ifelse(lowFreqRegime, dpwOrder1, dpwOrder3);
-				}
+	// the rate (steps of the plan per step of the output), step size and DPW scaling for an output
+	struct OutputRate {
+		int stride;
+		int numSteps;
+		float_4 deltaPhase;
+		// floating point arithmetic doesn't work well at low frequencies, specifically because the finite difference denominator
+		// becomes tiny - we check for that scenario and use naive / 1st order waveforms in that frequency regime (as aliasing isn't
+		// a problem there). With no oversampling, at 44100Hz, the threshold frequency is 44.1Hz.
+		float_4 lowFreqRegime;
+		// 1 / denominator for the second-order FD
+		float_4 denominatorInv;
+		// where the DPW histories can't be carried on from the previous sample (sync, or a change in frequency)
+		float_4 restart;
+	};
 
-				if (outputs[SQUARE_OUTPUT].isConnected()) {
+	OutputRate getOutputRate(const Steps& steps, int output) {
+		OutputRate rate;
+		rate.numSteps = oversampler[output][steps.group].getOversamplingRatio();
+		rate.stride = steps.numSteps / rate.numSteps;
+		rate.deltaPhase = steps.deltaPhase * rate.stride;
+		rate.lowFreqRegime = simd::abs(rate.deltaPhase) < 1e-3;
+		rate.denominatorInv = 0.25 / (rate.deltaPhase * rate.deltaPhase);
+		rate.restart = steps.syncMask | dpw::isRateChanged(rate.deltaPhase, previousDeltaPhase[output][steps.group]);
+		previousDeltaPhase[output][steps.group] = rate.deltaPhase;
+		return rate;
+	}
 
-					float_4 dpwOrder1 = simd::ifelse(phase[c / 4] < pw, -1.0, +1.0);
-					dpwOrder1 -= removePulseDC ? 2.f * (0.5f - pw) : 0.f;
+	void renderSine(const Steps& steps) {
+		const OutputRate rate = getOutputRate(steps, SINE_OUTPUT);
+		float_4* osBuffer = oversampler[SINE_OUTPUT][steps.group].getOSBuffer();
+		for (int i = 0; i < rate.numSteps; ++i) {
+			// sin doesn't need PDW
+			osBuffer[i] = -simd::cos(2.0 * M_PI * steps.phases[(i + 1) * rate.stride - 1]);
+		}
+	}
 
-					float_4 saw = aliasSuppressedSaw(phases);
-					float_4 sawOffset = aliasSuppressedOffsetSaw(phases, pw);
-					float_4 dpwOrder3 = (saw - sawOffset) * denominatorInv + pulseDCOffset;
+	void renderTri(const Steps& steps) {
+		const OutputRate rate = getOutputRate(steps, TRI_OUTPUT);
+		dpw::History<float_4>& history = triHistory[steps.group];
+		history.extrapolate(rate.restart, steps.phases[rate.stride - 1], rate.deltaPhase, dpw::tri<float_4>);
 
-					osBufferSquare[i] = simd::ifelse(lowFreqRegime, dpwOrder1, dpwOrder3);
-				}
+		float_4* osBuffer = oversampler[TRI_OUTPUT][steps.group].getOSBuffer();
+		for (int i = 0; i < rate.numSteps; ++i) {
+			const float_4 phase = steps.phases[(i + 1) * rate.stride - 1];
+			const float_4 dpwOrder1 = 1.0 - 2.0 * simd::abs(2 * phase - 1.0);
+			const float_4 dpwOrder3 = history.process(dpw::tri(phase)) * rate.denominatorInv;
 
-				if (outputs[EVEN_OUTPUT].isConnected()) {
+			osBuffer[i] = simd::ifelse(rate.lowFreqRegime, dpwOrder1, dpwOrder3);
+		}
+	}
 
-					float_4 dpwOrder1 = 4.0 * simd::ifelse(phase[c / 4] < 0.5, phase[c / 4], phase[c / 4] - 0.5) - 1.0;
-					float_4 dpwOrder3 = aliasSuppressedDoubleSaw(phases) * denominatorInv;
-					float_4 doubleSaw = simd::ifelse(lowFreqRegime, dpwOrder1, dpwOrder3);
-					osBufferEven[i] = 0.55 * (doubleSaw + 1.27 * osBufferSin[i]);
-				}
+	void renderSaw(const Steps& steps) {
+		const OutputRate rate = getOutputRate(steps, SAW_OUTPUT);
+		dpw::History<float_4>& history = sawHistory[steps.group];
+		history.extrapolate(rate.restart, steps.phases[rate.stride - 1], rate.deltaPhase, dpw::saw<float_4>);
 
+		float_4* osBuffer = oversampler[SAW_OUTPUT][steps.group].getOSBuffer();
+		for (int i = 0; i < rate.numSteps; ++i) {
+			const float_4 phase = steps.phases[(i + 1) * rate.stride - 1];
+			const float_4 dpwOrder1 = 2 * phase - 1.0;
+			const float_4 dpwOrder3 = history.process(dpw::saw(phase)) * rate.denominatorInv;
 
-			} 	// end of oversampling loop
+			osBuffer[i] = simd::ifelse(rate.lowFreqRegime, dpwOrder1, dpwOrder3);
+		}
+	}
 
-			// downsample (if required)
-			if (outputs[SINE_OUTPUT].isConnected()) {
-				const float_4 outSin = (oversamplingRatio > 1) ? oversampler[SINE_OUTPUT][c / 4].downsample() : osBufferSin[0];
-				outputs[SINE_OUTPUT].setVoltageSimd(5.f * outSin, c);
+	// the square (and, if `sawBuffer`, the saw too) with the saw polynomial's history `saws`
+	void renderSquare(const Steps& steps, const OutputRate& rate, dpw::History<float_4>& saws, float_4* sawBuffer) {
+		const float_4 pw = steps.pw;
+		const auto offsetSaw = [pw](float_4 x) {
+			return dpw::offsetSaw(x, pw);
+		};
+		const float_4 firstPhase = steps.phases[rate.stride - 1];
+		saws.extrapolate(rate.restart, firstPhase, rate.deltaPhase, dpw::saw<float_4>);
+		offsetSawHistory[steps.group].extrapolate(rate.restart | (pw != previousPW[steps.group]), firstPhase, rate.deltaPhase, offsetSaw);
+
+		float_4* osBuffer = oversampler[SQUARE_OUTPUT][steps.group].getOSBuffer();
+		for (int i = 0; i < rate.numSteps; ++i) {
+			const float_4 phase = steps.phases[(i + 1) * rate.stride - 1];
+			const float_4 saw = saws.process(dpw::saw(phase));
+
+			float_4 dpwOrder1 = simd::ifelse(phase < pw, -1.0, +1.0);
+			dpwOrder1 -= removePulseDC ? 2.f * (0.5f - pw) : 0.f;
+
+			const float_4 sawOffset = offsetSawHistory[steps.group].process(offsetSaw(phase));
+			const float_4 dpwOrder3 = (saw - sawOffset) * rate.denominatorInv + steps.pulseDCOffset;
+
+			osBuffer[i] = simd::ifelse(rate.lowFreqRegime, dpwOrder1, dpwOrder3);
+			if (sawBuffer) {
+				sawBuffer[i] = simd::ifelse(rate.lowFreqRegime, 2 * phase - 1.0, saw * rate.denominatorInv);
 			}
+		}
+	}
 
-			if (outputs[TRI_OUTPUT].isConnected()) {
-				const float_4 outTri = (oversamplingRatio > 1) ? oversampler[TRI_OUTPUT][c / 4].downsample() : osBufferTri[0];
-				outputs[TRI_OUTPUT].setVoltageSimd(5.f * outTri, c);
-			}
+	void renderSquare(const Steps& steps) {
+		renderSquare(steps, getOutputRate(steps, SQUARE_OUTPUT), squareSawHistory[steps.group], nullptr);
+	}
 
-			if (outputs[SAW_OUTPUT].isConnected()) {
-				const float_4 outSaw = (oversamplingRatio > 1) ? oversampler[SAW_OUTPUT][c / 4].downsample() : osBufferSaw[0];
-				outputs[SAW_OUTPUT].setVoltageSimd(5.f * outSaw, c);
-			}
+	// (both at the same rate)
+	void renderSawAndSquare(const Steps& steps) {
+		const OutputRate rate = getOutputRate(steps, SQUARE_OUTPUT);
+		previousDeltaPhase[SAW_OUTPUT][steps.group] = rate.deltaPhase;
+		renderSquare(steps, rate, sawHistory[steps.group], oversampler[SAW_OUTPUT][steps.group].getOSBuffer());
+	}
 
-			if (outputs[SQUARE_OUTPUT].isConnected()) {
-				const float_4 outSquare = (oversamplingRatio > 1) ? oversampler[SQUARE_OUTPUT][c / 4].downsample() : osBufferSquare[0];
-				outputs[SQUARE_OUTPUT].setVoltageSimd(5.f * outSquare, c);
-			}
+	void renderEven(const Steps& steps) {
+		const OutputRate rate = getOutputRate(steps, EVEN_OUTPUT);
+		dpw::History<float_4>& history = doubleSawHistory[steps.group];
+		history.extrapolate(rate.restart, steps.phases[rate.stride - 1], rate.deltaPhase, dpw::doubleSaw<float_4>);
+
+		float_4* osBuffer = oversampler[EVEN_OUTPUT][steps.group].getOSBuffer();
+		for (int i = 0; i < rate.numSteps; ++i) {
+			const float_4 phase = steps.phases[(i + 1) * rate.stride - 1];
+			const float_4 dpwOrder1 = 4.0 * simd::ifelse(phase < 0.5, phase, phase - 0.5) - 1.0;
+			const float_4 dpwOrder3 = history.process(dpw::doubleSaw(phase)) * rate.denominatorInv;
+			const float_4 doubleSaw = simd::ifelse(rate.lowFreqRegime, dpwOrder1, dpwOrder3);
+			// (its own sine, at its own rate)
+			const float_4 sine = -simd::cos(2.0 * M_PI * phase);
+			osBuffer[i] = 0.55 * (doubleSaw + 1.27 * sine);
+		}
+	}
+
+	// the same for all outputs
+	void setOversamplingIndex(int index) {
+		for (int i = 0; i < NUM_OUTPUTS; i++) {
+			oversamplingIndex[i] = clamp(index, 0, MAX_OVERSAMPLING_INDEX);
+		}
+	}
 
-			if (outputs[EVEN_OUTPUT].isConnected()) {
-				const float_4 outEven = (oversamplingRatio > 1) ? oversampler[EVEN_OUTPUT][c / 4].downsample() : osBufferEven[0];
-				outputs[EVEN_OUTPUT].setVoltageSimd(5.f * outEven, c);
+	// -1 if the outputs differ
+	int getOversamplingIndex() {
+		for (int i = 1; i < NUM_OUTPUTS; i++) {
+			if (oversamplingIndex[i] != oversamplingIndex[0]) {
+				return -1;
 			}
+		}
+		return oversamplingIndex[0];
+	}
 
-		} 	// end of channels loop
+	// polyBLEP kernels: the naive waveforms with the residuals of their steps and corners (but not those from hard sync)
 
-		// Outputs
-		outputs[TRI_OUTPUT].setChannels(channels);
-		outputs[SINE_OUTPUT].setChannels(channels);
-		outputs[EVEN_OUTPUT].setChannels(channels);
-		outputs[SAW_OUTPUT].setChannels(channels);
-		outputs[SQUARE_OUTPUT].setChannels(channels);
+	void renderTriBLEP(const Steps& steps) {
+		const OutputRate rate = getOutputRate(steps, TRI_OUTPUT);
+		float_4* osBuffer = oversampler[TRI_OUTPUT][steps.group].getOSBuffer();
+		for (int i = 0; i < rate.numSteps; ++i) {
+			osBuffer[i] = polyblep::tri(steps.phases[(i + 1) * rate.stride - 1], rate.deltaPhase);
+		}
 	}
 
+	void renderSawBLEP(const Steps& steps) {
+		const OutputRate rate = getOutputRate(steps, SAW_OUTPUT);
+		float_4* osBuffer = oversampler[SAW_OUTPUT][steps.group].getOSBuffer();
+		for (int i = 0; i < rate.numSteps; ++i) {
+			osBuffer[i] = polyblep::saw(steps.phases[(i + 1) * rate.stride - 1], rate.deltaPhase);
+		}
+	}
+
+	void renderSquareBLEP(const Steps& steps) {
+		const OutputRate rate = getOutputRate(steps, SQUARE_OUTPUT);
+		const float_4 dcOffset = removePulseDC ? 2.f * (0.5f - steps.pw) : 0.f;
+		float_4* osBuffer = oversampler[SQUARE_OUTPUT][steps.group].getOSBuffer();
+		for (int i = 0; i < rate.numSteps; ++i) {
+			osBuffer[i] = polyblep::pulse(steps.phases[(i + 1) * rate.stride - 1], rate.deltaPhase, steps.pw) - dcOffset;
+		}
+	}
+
+	void renderEvenBLEP(const Steps& steps) {
+		const OutputRate rate = getOutputRate(steps, EVEN_OUTPUT);
+		// the double saw's step, limited to where the residuals are valid (it's above Nyquist beyond that)
+		const float_4 deltaDoublePhase = simd::fmin(2.f * rate.deltaPhase, 0.5f);
+		float_4* osBuffer = oversampler[EVEN_OUTPUT][steps.group].getOSBuffer();
+		for (int i = 0; i < rate.numSteps; ++i) {
+			const float_4 phase = steps.phases[(i + 1) * rate.stride - 1];
+			const float_4 doublePhase = 2.f * phase - simd::floor(2.f * phase);
+			const float_4 doubleSaw = polyblep::saw(doublePhase, deltaDoublePhase);
+			const float_4 sine = -simd::cos(2.0 * M_PI * phase);
+			osBuffer[i] = 0.55 * (doubleSaw + 1.27 * sine);
+		}
+	}
 
 	json_t* dataToJson() override {
 		json_t* rootJ = json_object();
 		json_object_set_new(rootJ, "removePulseDC", json_boolean(removePulseDC));
 		json_object_set_new(rootJ, "limitPW", json_boolean(limitPW));
-		json_object_set_new(rootJ, "oversamplingIndex", json_integer(oversampler[0][0].getOversamplingIndex()));
+		// (the settings, rather than the factors in use, which polyBLEP overrides)
+		json_object_set_new(rootJ, "oversamplingIndex", json_integer(oversamplingIndex[0]));
+		json_t* outputOversamplingIndexJ = json_array();
+		for (int i = 0; i < NUM_OUTPUTS; i++) {
+			json_array_append_new(outputOversamplingIndexJ, json_integer(oversamplingIndex[i]));
+		}
+		json_object_set_new(rootJ, "outputOversamplingIndex", outputOversamplingIndexJ);
+		json_object_set_new(rootJ, "oversamplingFilter", json_integer(oversamplingFilter));
+		json_object_set_new(rootJ, "oscillatorEngine", json_integer(oscillatorEngine));
 		return rootJ;
 	}
 
@@ -265,11 +461,29 @@ struct EvenVCO : Module {
 			limitPW = json_boolean_value(limitPWJ);
 		}
 
+		json_t* oversamplingFilterJ = json_object_get(rootJ, "oversamplingFilter");
+		if (oversamplingFilterJ) {
+			oversamplingFilter = (chowdsp::OversamplingFilterType) json_integer_value(oversamplingFilterJ);
+		}
+
+		json_t* oscillatorEngineJ = json_object_get(rootJ, "oscillatorEngine");
+		if (oscillatorEngineJ) {
+			oscillatorEngine = (OscillatorEngine) clamp((int) json_integer_value(oscillatorEngineJ), 0, NUM_ENGINES - 1);
+		}
+
+		// older patches have a single setting for all outputs
 		json_t* oversamplingIndexJ = json_object_get(rootJ, "oversamplingIndex");
 		if (oversamplingIndexJ) {
-			oversamplingIndex = json_integer_value(oversamplingIndexJ);
-			onSampleRateChange();
+			setOversamplingIndex(json_integer_value(oversamplingIndexJ));
+		}
+
+		json_t* outputOversamplingIndexJ = json_object_get(rootJ, "outputOversamplingIndex");
+		if (outputOversamplingIndexJ) {
+			for (int i = 0; i < NUM_OUTPUTS && i < (int) json_array_size(outputOversamplingIndexJ); i++) {
+				oversamplingIndex[i] = clamp((int) json_integer_value(json_array_get(outputOversamplingIndexJ, i)), 0, MAX_OVERSAMPLING_INDEX);
+			}
 		}
+		onSampleRateChange();
 	}
 };
 
@@ -314,14 +528,53 @@ struct EvenVCOWidget : ModuleWidget {
 		}
 		                                ));
 
+		menu->addChild(createIndexSubmenuItem("Oscillator engine",
+		{"DPW (oversampled)", "PolyBLEP (no oversampling)"},
+		[ = ]() {
+			return module->oscillatorEngine;
+		},
+		[ = ](int mode) {
+			module->oscillatorEngine = (EvenVCO::OscillatorEngine) mode;
+			module->requestOversamplingChange();
+		}
+		                                     ));
+
 		menu->addChild(createIndexSubmenuItem("Oversampling",
 		{"Off", "x2", "x4", "x8"},
 		[ = ]() {
-			return module->oversamplingIndex;
+			return module->getOversamplingIndex();
+		},
+		[ = ](int mode) {
+			module->setOversamplingIndex(mode);
+			module->requestOversamplingChange();
+		}
+		                                     ));
+
+		menu->addChild(createSubmenuItem("Oversampling per output", "",
+		[ = ](Menu * menu) {
+			for (int i = 0; i < EvenVCO::NUM_OUTPUTS; i++) {
+				menu->addChild(createIndexSubmenuItem(module->outputInfos[i]->name,
+				{"Off", "x2", "x4", "x8"},
+				[ = ]() {
+					return module->oversamplingIndex[i];
+				},
+				[ = ](int mode) {
+					module->oversamplingIndex[i] = mode;
+					module->requestOversamplingChange();
+				}
+				                                     ));
+			}
+		}
+		                                ));
+
+		menu->addChild(createIndexSubmenuItem("Oversampling filter",
+		{"Low latency (IIR)", "High quality (FIR)"},
+		[ = ]() {
+			return module->oversamplingFilter;
 		},
 		[ = ](int mode) {
-			module->oversamplingIndex = mode;
-			module->onSampleRateChange();
+			module->oversamplingFilter = (chowdsp::OversamplingFilterType) mode;
+			module->requestOversamplingChange();
 		}
 		                                     ));
 	}
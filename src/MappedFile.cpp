@@ -0,0 +1,85 @@
+#include "MappedFile.hpp"
+
+#if defined ARCH_WIN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace rack;
+
+#if defined ARCH_WIN
+
+MappedFile::MappedFile(const std::string& path) {
+	HANDLE file = CreateFileW(string::UTF8toUTF16(path).c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) {
+		throw Exception("Cannot open %s", path.c_str());
+	}
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize)) {
+		CloseHandle(file);
+		throw Exception("Cannot get size of %s", path.c_str());
+	}
+	length = fileSize.QuadPart;
+	// an empty file can't be mapped, but is valid
+	if (length > 0) {
+		mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping) {
+			bytes = (const uint8_t*) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		}
+	}
+	// the mapping keeps the file open
+	CloseHandle(file);
+	if (length > 0 && !bytes) {
+		if (mapping) {
+			CloseHandle(mapping);
+		}
+		throw Exception("Cannot map %s", path.c_str());
+	}
+}
+
+MappedFile::~MappedFile() {
+	if (bytes) {
+		UnmapViewOfFile(bytes);
+	}
+	if (mapping) {
+		CloseHandle(mapping);
+	}
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) {
+	const int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		throw Exception("Cannot open %s", path.c_str());
+	}
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0) {
+		close(fd);
+		throw Exception("Cannot get size of %s", path.c_str());
+	}
+	length = fileStat.st_size;
+	// an empty file can't be mapped, but is valid
+	if (length > 0) {
+		void* address = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (address == MAP_FAILED) {
+			close(fd);
+			throw Exception("Cannot map %s", path.c_str());
+		}
+		bytes = (const uint8_t*) address;
+	}
+	// the mapping keeps the file open
+	close(fd);
+}
+
+MappedFile::~MappedFile() {
+	if (bytes) {
+		munmap((void*) bytes, length);
+	}
+}
+
+#endif
@@ -0,0 +1,30 @@
+#pragma once
+#include <rack.hpp>
+
+/**
+ * Read-only memory map of a whole file, so large assets (e.g. impulse responses) are paged in from the
+ * OS file cache as they are read, rather than copied onto the heap. Throws rack::Exception if the file
+ * can't be opened or mapped.
+ */
+class MappedFile {
+public:
+	explicit MappedFile(const std::string& path);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const uint8_t* data() const {
+		return bytes;
+	}
+	size_t size() const {
+		return length;
+	}
+
+private:
+	const uint8_t* bytes = nullptr;
+	size_t length = 0;
+#if defined ARCH_WIN
+	void* mapping = nullptr;
+#endif
+};
@@ -1,6 +1,9 @@
 #include "plugin.hpp"
 #include "noise-plethora/plugins/NoisePlethoraPlugin.hpp"
 #include "noise-plethora/plugins/ProgramSelector.hpp"
+#include "noise-plethora/plugins/AlgorithmPool.hpp"
+#include "noise-plethora/plugins/ProgramProfiler.hpp"
+#include "RenderWorkers.hpp"
 
 enum FilterMode {
 	LOWPASS,
@@ -160,15 +163,83 @@ struct NoisePlethora : Module {
 
 	// section A/B
 	bool bypassFilters = false;
-	std::shared_ptr<NoisePlethoraPlugin> algorithm[2]{nullptr, nullptr}; 	// pointer to actual algorithm
-	std::string_view algorithmName[2]{"", ""};				// variable to cache which algorithm is active (after program CV applied)
-	std::map<std::string_view, std::shared_ptr<NoisePlethoraPlugin>> A_algorithms{};
-	std::map<std::string_view, std::shared_ptr<NoisePlethoraPlugin>> B_algorithms{};
+	// one voice per channel of A/B (just the first unless polyphonic), each running its own algorithm
+	struct Voice {
+		NoisePlethoraPlugin* algorithm = nullptr; 	// pointer to actual algorithm (owned by the voice's algorithmPool)
+		int program = -1; 							// variable to cache which program is active (after program CV applied)
+		float gain = 1.f; 							// the algorithm's specific gain factor
+		bool restarted = false; 					// algorithm changed since the last sample, so its block must be restarted
+		// after a program change, the previous algorithm fades out as the new one fades in
+		NoisePlethoraPlugin* fadingAlgorithm = nullptr;
+		int fadingProgram = -1;
+		float fadingGain = 1.f;
+		float crossfade = 0.f; 						// 0 to 1 over crossfadeTimeSecs
+		// when rendering ahead, the latest update waits for the next block (the algorithms may be rendering)
+		float pendingX = 0.f, pendingY = 0.f;
+		bool updatePending = false;
+		// filters
+		StateVariableFilter2ndOrder svfFilter;
+		DCBlocker blockDCFilter;
+	};
+	bool polyphonic = false; 							// channels of X, Y, program and cutoff CV each drive a voice
+	Voice voices[2][PORT_MAX_CHANNELS];
+	AlgorithmPool algorithmPool[2][PORT_MAX_CHANNELS]; 	// the few most recently used algorithms per voice, created on demand
+	int numVoices[2] = {1, 1};
+	// position in the current block, which all of a section's voices render in step
+	int blockPosition[2] = {};
+	teensy::ProcessingMode processingMode = teensy::HARDWARE_EXACT; 	// arithmetic used by the algorithms' Teensy primitives
+	// samples rendered by each of the algorithms' blocks, the hardware's AUDIO_BLOCK_SAMPLES or smaller
+	static constexpr int NUM_BLOCK_SIZES = 5;
+	static constexpr int blockSizes[NUM_BLOCK_SIZES] = {8, 16, 32, 64, AUDIO_BLOCK_SAMPLES};
+	int blockSize = AUDIO_BLOCK_SAMPLES;
+	// optionally, time every block each program renders
+	bool profilePrograms = false;
+	ProgramProfiler programProfiler;
+
+	// an algorithm's block to render
+	struct Render {
+		int program;
+		NoisePlethoraPlugin* algorithm;
+		double seconds; 	// time taken, if profiled
+	};
+	// optionally, each section's next blocks are rendered by the render workers while the current ones play, so
+	// A and B can run on separate cores (at the cost of a block's delay to X/Y changes)
+	bool renderAhead = false;
+	struct BlockRenderJob : RenderJob {
+		Render renders[2 * PORT_MAX_CHANNELS];
+		int numRenders = 0;
+		// (as set by the module for the audio thread)
+		teensy::ProcessingMode processingMode = teensy::HARDWARE_EXACT;
+		int blockSize = AUDIO_BLOCK_SAMPLES;
+		bool profile = false;
+
+		bool contains(const NoisePlethoraPlugin* algorithm) const {
+			for (int i = 0; i < numRenders; i++) {
+				if (renders[i].algorithm == algorithm) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void run() override {
+			teensy::processingMode() = processingMode;
+			teensy::blockSamples() = blockSize;
+			for (int i = 0; i < numRenders; i++) {
+				if (profile) {
+					const ProgramProfiler::Timer timer;
+					renders[i].algorithm->renderNextBlock();
+					renders[i].seconds = timer.getSeconds();
+				}
+				else {
+					renders[i].algorithm->renderNextBlock();
+				}
+			}
+		}
+	};
+	BlockRenderJob renderJobs[2];
 
-	// filters for A/B
-	StateVariableFilter2ndOrder svfFilter[2];
 	bool blockDC = true;
-	DCBlocker blockDCFilter[3];
 
 	ProgramSelector programSelector; 		// tracks banks and programs for both sections A/B, including which is the "active" section
 	ProgramSelector programSelectorWithCV; 	// as above, but also with CV for program applied as an offset - works like Plaits Model CV input
@@ -182,11 +253,16 @@ struct NoisePlethora : Module {
 
 	dsp::PulseGenerator updateParamsTimer;
 	const float updateTimeSecs = 0.0029f;
+	const float crossfadeTimeSecs = 0.01f;
+
+	// seeds all of the module's noise (saved with the patch, so renders of it repeat), random per instance
+	uint64_t seed = 0;
 
 	// section C
 	AudioSynthNoiseWhiteFloat whiteNoiseSource;
 	AudioSynthNoiseGritFloat gritNoiseSource;
 	StateVariableFilter4thOrder svfFilterC;
+	DCBlocker blockDCFilterC;
 	FilterMode typeMappingSVF[3] = {LOWPASS, BANDPASS, HIGHPASS};
 
 	NoisePlethora()  {
@@ -233,19 +309,20 @@ struct NoisePlethora : Module {
 		getInputInfo(PROG_A_INPUT)->description = "CV sums with active program (0.5V increments)";
 		getInputInfo(PROG_B_INPUT)->description = "CV sums with active program (0.5V increments)";
 
-		for (auto const &entry : MyFactory::Instance()->factoryFunctionRegistry) {
-			A_algorithms[entry.first] = MyFactory::Instance()->Create(entry.first);
-			B_algorithms[entry.first] = MyFactory::Instance()->Create(entry.first);
-		}
-
-		setAlgorithm(SECTION_B, "radioOhNo");
-		setAlgorithm(SECTION_A, "radioOhNo");
+		setSeed(random::u64());
+		loadAlgorithm(SECTION_B, "radioOhNo");
+		loadAlgorithm(SECTION_A, "radioOhNo");
 		onSampleRateChange();
 	}
 
+	~NoisePlethora() {
+		// (workers may be rendering)
+		setRenderAhead(false);
+	}
+
 	void onReset(const ResetEvent& e) override {
-		setAlgorithm(SECTION_B, "radioOhNo");
-		setAlgorithm(SECTION_A, "radioOhNo");
+		loadAlgorithm(SECTION_B, "radioOhNo");
+		loadAlgorithm(SECTION_A, "radioOhNo");
 		Module::onReset(e);
 	}
 
@@ -253,15 +330,18 @@ struct NoisePlethora : Module {
 		// set ~20Hz DC blocker
 		const float fc = 22.05f / APP->engine->getSampleRate();
 
-		blockDCFilter[SECTION_A].setFrequency(fc);
-		blockDCFilter[SECTION_B].setFrequency(fc);
-		blockDCFilter[SECTION_C].setFrequency(fc);
-
-		if (algorithm[SECTION_A]) {
-			algorithm[SECTION_A]->init();
-		}
-		if (algorithm[SECTION_B]) {
-			algorithm[SECTION_B]->init();
+		blockDCFilterC.setFrequency(fc);
+		for (int section : {SECTION_A, SECTION_B}) {
+			finishRenderAhead((Section) section);
+			for (int c = 0; c < PORT_MAX_CHANNELS; c++) {
+				Voice& voice = voices[section][c];
+				voice.blockDCFilter.setFrequency(fc);
+				if (voice.algorithm) {
+					voice.algorithm->init();
+					voice.restarted = true;
+				}
+				endCrossfade((Section) section, c);
+			}
 		}
 	}
 
@@ -274,6 +354,10 @@ struct NoisePlethora : Module {
 			updateParamsTimer.trigger(updateTimeSecs);
 		}
 
+		// the Teensy primitives' mode is per thread, and other instances may run on this one
+		teensy::processingMode() = processingMode;
+		teensy::blockSamples() = blockSize;
+
 		// process A, B and C
 		processTopSection(SECTION_A, X_A_PARAM, Y_A_PARAM,
 		                  FILTER_TYPE_A_PARAM, CUTOFF_A_PARAM, CUTOFF_CV_A_PARAM, RES_A_PARAM,
@@ -288,11 +372,11 @@ struct NoisePlethora : Module {
 		processProgramBankKnobLogic(args);
 	}
 
-	// process CV for section, specifically: work out the offset relative to the current
+	// process CV for a voice of the section, specifically: work out the offset relative to the current
 	// program and see if this is a new algorithm
-	void processCVOffsets(Section SECTION, InputIds PROG_INPUT) {
+	void processCVOffsets(Section SECTION, InputIds PROG_INPUT, int c) {
 
-		const int offset = 2 * inputs[PROG_INPUT].getVoltage();
+		const int offset = 2 * inputs[PROG_INPUT].getPolyVoltage(c);
 
 		const int bank = programSelector.getSection(SECTION).getBank();
 		const int numProgramsForBank = getBankForIndex(bank).getSize();
@@ -300,78 +384,312 @@ struct NoisePlethora : Module {
 		const int programWithoutCV = programSelector.getSection(SECTION).getProgram();
 		const int programWithCV = unsigned_modulo(programWithoutCV + offset, numProgramsForBank);
 
-		// duplicate key settings to programSelectorWithCV (expect modified program)
-		programSelectorWithCV.setMode(programSelector.getMode());
-		programSelectorWithCV.getSection(SECTION).setBank(bank);
-		programSelectorWithCV.getSection(SECTION).setProgram(programWithCV);
+		// duplicate key settings to programSelectorWithCV (expect modified program), which follows the first voice
+		if (c == 0) {
+			programSelectorWithCV.setMode(programSelector.getMode());
+			programSelectorWithCV.getSection(SECTION).setBank(bank);
+			programSelectorWithCV.getSection(SECTION).setProgram(programWithCV);
+		}
 
-		std::string_view newAlgorithmName = programSelectorWithCV.getSection(SECTION).getCurrentProgramName();
+		const int newProgram = getProgramId(bank, programWithCV);
 
-		// this is just a caching check to avoid constantly re-initialisating the algorithms
-		if (newAlgorithmName != algorithmName[SECTION]) {
+		// this is just a caching check to avoid constantly re-initialisating the algorithms (and a change during
+		// a crossfade waits for it to finish)
+		Voice& voice = voices[SECTION][c];
+		if (voice.fadingAlgorithm) {
+			return;
+		}
+		if (newProgram != voice.program) {
+
+			// if the algorithm isn't cached, it's created in the background (never allocate here), and until
+			// it's ready the current algorithm keeps playing; it's initialised in the background too, unless
+			// it's been played before
+			NoisePlethoraPlugin* newAlgorithm = algorithmPool[SECTION][c].acquire(newProgram);
+			if (newAlgorithm) {
+				// fade from the current algorithm (if any), rather than jumping
+				if (voice.algorithm) {
+					voice.fadingAlgorithm = voice.algorithm;
+					voice.fadingProgram = voice.program;
+					voice.fadingGain = voice.gain;
+					voice.crossfade = 0.f;
+				}
+				voice.algorithm = newAlgorithm;
+				voice.program = newProgram;
+				voice.gain = getBankForIndex(bank).getProgramGain(programWithCV);
+				voice.restarted = true;
+			}
+		}
+		else {
+			// have the neighbouring programs (where CV is most likely to go next) made ready in the background
+			algorithmPool[SECTION][c].prefetch(getProgramId(bank, unsigned_modulo(programWithCV - 1, numProgramsForBank)));
+			algorithmPool[SECTION][c].prefetch(getProgramId(bank, unsigned_modulo(programWithCV + 1, numProgramsForBank)));
+		}
+	}
 
-			algorithm[SECTION] = SECTION == Section::SECTION_A ? A_algorithms[newAlgorithmName] : B_algorithms[newAlgorithmName];
-			algorithmName[SECTION] = newAlgorithmName;
+	void endCrossfade(Section SECTION, int c) {
+		if (voices[SECTION][c].fadingAlgorithm) {
+			voices[SECTION][c].fadingAlgorithm = nullptr;
+			algorithmPool[SECTION][c].releasePrevious();
+		}
+	}
 
-			if (algorithm[SECTION]) {
-				algorithm[SECTION]->init();
+	// render the section's next blocks (or just those of algorithms restarted mid-block), with the voices running the
+	// same program one after another, so its code and tables are only brought into cache once; algorithms started
+	// mid-block render a whole block and skip ahead, so they stay in step with the others
+	void renderBlocks(Section SECTION, int channels) {
+		// (including algorithms fading out)
+		Render order[2 * PORT_MAX_CHANNELS];
+		int numToRender = 0;
+		for (int c = 0; c < channels; c++) {
+			Voice& voice = voices[SECTION][c];
+			if (voice.algorithm && (blockPosition[SECTION] == 0 || voice.restarted)) {
+				order[numToRender++] = {voice.program, voice.algorithm, 0.0};
+			}
+			if (voice.fadingAlgorithm && blockPosition[SECTION] == 0) {
+				order[numToRender++] = {voice.fadingProgram, voice.fadingAlgorithm, 0.0};
+			}
+			voice.restarted = false;
+		}
+		sortByProgram(order, numToRender);
+		for (int i = 0; i < numToRender; i++) {
+			if (profilePrograms) {
+				const ProgramProfiler::Timer timer;
+				order[i].algorithm->renderBlock(blockPosition[SECTION]);
+				programProfiler.record(order[i].program, timer.getSeconds(), blockSize);
 			}
 			else {
-				DEBUG("WARNING: Failed to initialise %s in programSelector", newAlgorithmName.data());
+				order[i].algorithm->renderBlock(blockPosition[SECTION]);
 			}
 		}
 	}
 
+	static void sortByProgram(Render* renders, int numRenders) {
+		std::sort(renders, renders + numRenders, [](const Render& a, const Render& b) {
+			return a.program < b.program;
+		});
+	}
+
+	// as renderBlocks(), but at the start of each block the voices' next blocks are posted to the render workers,
+	// to be ready (waited for if need be) by the start of the next; only algorithms without the current block
+	// (e.g. new, or restarted) are rendered here, as are algorithms restarted mid-block
+	void renderBlocksAhead(Section SECTION, int channels) {
+		BlockRenderJob& job = renderJobs[SECTION];
+
+		if (blockPosition[SECTION] != 0) {
+			// a voice coming back into use may still be rendering ahead
+			for (int c = 0; c < channels; c++) {
+				if (voices[SECTION][c].restarted && job.isPending() && job.contains(voices[SECTION][c].algorithm)) {
+					finishRenderAhead(SECTION);
+				}
+			}
+			renderBlocks(SECTION, channels);
+			return;
+		}
+
+		finishRenderAhead(SECTION);
+		for (int c = 0; c < channels; c++) {
+			Voice& voice = voices[SECTION][c];
+			// crossfades finishing mid-block release their algorithm here, as it could still be rendering
+			if (voice.fadingAlgorithm && voice.crossfade >= 1.f) {
+				endCrossfade(SECTION, c);
+			}
+			if (voice.updatePending) {
+				voice.algorithm->process(voice.pendingX, voice.pendingY);
+				if (voice.fadingAlgorithm) {
+					voice.fadingAlgorithm->process(voice.pendingX, voice.pendingY);
+				}
+				voice.updatePending = false;
+			}
+			// (not rendered ahead, or left out of step, e.g. by a change of block size)
+			voice.restarted |= voice.algorithm && voice.algorithm->getBufferedSamples() != blockSize;
+			if (voice.fadingAlgorithm && voice.fadingAlgorithm->getBufferedSamples() != blockSize) {
+				voice.fadingAlgorithm->renderBlock();
+			}
+		}
+		// renderBlocks() would render every voice at the start of a block, so just the restarted ones
+		Render order[PORT_MAX_CHANNELS];
+		int numToRender = 0;
+		for (int c = 0; c < channels; c++) {
+			Voice& voice = voices[SECTION][c];
+			if (voice.algorithm && voice.restarted) {
+				order[numToRender++] = {voice.program, voice.algorithm, 0.0};
+			}
+			voice.restarted = false;
+		}
+		sortByProgram(order, numToRender);
+		for (int i = 0; i < numToRender; i++) {
+			order[i].algorithm->renderBlock();
+		}
+
+		job.numRenders = 0;
+		for (int c = 0; c < channels; c++) {
+			Voice& voice = voices[SECTION][c];
+			if (voice.algorithm) {
+				job.renders[job.numRenders++] = {voice.program, voice.algorithm, 0.0};
+			}
+			if (voice.fadingAlgorithm) {
+				job.renders[job.numRenders++] = {voice.fadingProgram, voice.fadingAlgorithm, 0.0};
+			}
+		}
+		sortByProgram(job.renders, job.numRenders);
+		job.processingMode = processingMode;
+		job.blockSize = blockSize;
+		job.profile = profilePrograms;
+		if (job.numRenders > 0) {
+			job.post();
+		}
+	}
+
+	// waits for the section's blocks being rendered ahead (if any), after which the audio thread can use its algorithms
+	void finishRenderAhead(Section SECTION) {
+		BlockRenderJob& job = renderJobs[SECTION];
+		if (!job.isPending()) {
+			return;
+		}
+		job.wait();
+		if (job.profile) {
+			for (int i = 0; i < job.numRenders; i++) {
+				programProfiler.record(job.renders[i].program, job.renders[i].seconds, job.blockSize);
+			}
+		}
+	}
+
+	// section C's noise sources and the algorithms created from now on, each voice's from its own stream
+	void setSeed(uint64_t newSeed) {
+		seed = newSeed;
+		uint64_t state = seed;
+		whiteNoiseSource.seed(teensy::splitMix64(state));
+		gritNoiseSource.seed(teensy::splitMix64(state));
+		for (int section : {SECTION_A, SECTION_B}) {
+			for (int c = 0; c < PORT_MAX_CHANNELS; c++) {
+				algorithmPool[section][c].setSeed(teensy::splitMix64(state));
+			}
+		}
+	}
+
+	// not for the audio thread
+	void setRenderAhead(bool enabled) {
+		renderAhead = enabled;
+		for (BlockRenderJob& job : renderJobs) {
+			job.setEnabled(enabled);
+		}
+	}
+
 	// exactly the same for A and B
 	void processTopSection(Section SECTION, ParamIds X_PARAM, ParamIds Y_PARAM, ParamIds FILTER_TYPE_PARAM,
 	                       ParamIds CUTOFF_PARAM, ParamIds CUTOFF_CV_PARAM, ParamIds RES_PARAM,
 	                       InputIds PROG_INPUT, InputIds X_INPUT, InputIds Y_INPUT, InputIds CUTOFF_INPUT, OutputIds OUTPUT,
 	                       const ProcessArgs& args, bool updateParams) {
 
-		// periodically work out how CV should modify the current sections algorithm
-		if (updateParams) {
-			processCVOffsets(SECTION, PROG_INPUT);
+		const int channels = polyphonic ? std::max({1, inputs[X_INPUT].getChannels(), inputs[Y_INPUT].getChannels(),
+		                                            inputs[PROG_INPUT].getChannels(), inputs[CUTOFF_INPUT].getChannels()}) : 1;
+		// blocks rendered ahead must be finished before rendering here again, or at a different size
+		if (!renderAhead || renderJobs[SECTION].blockSize != blockSize) {
+			finishRenderAhead(SECTION);
 		}
+		// voices coming back into use have stale blocks
+		for (int c = numVoices[SECTION]; c < channels; c++) {
+			voices[SECTION][c].restarted = true;
+		}
+		numVoices[SECTION] = channels;
 
-		float out = 0.f;
-		if (algorithm[SECTION] && outputs[OUTPUT].isConnected()) {
-			float cvX = params[X_PARAM].getValue() + rescale(inputs[X_INPUT].getVoltage(), -10.f, +10.f, -1.f, 1.f);
-			float cvY = params[Y_PARAM].getValue() + rescale(inputs[Y_INPUT].getVoltage(), -10.f, +10.f, -1.f, 1.f);
+		// periodically work out how CV should modify the current sections algorithms
+		if (updateParams) {
+			for (int c = 0; c < channels; c++) {
+				processCVOffsets(SECTION, PROG_INPUT, c);
+			}
+		}
 
-			// update parameters of the algorithm
-			if (updateParams) {
-				algorithm[SECTION]->process(clamp(cvX, 0.f, 1.f), clamp(cvY, 0.f, 1.f));
+		outputs[OUTPUT].setChannels(channels);
+		if (!outputs[OUTPUT].isConnected()) {
+			// nothing to hear, so don't hold up program changes
+			finishRenderAhead(SECTION);
+			for (int c = 0; c < channels; c++) {
+				endCrossfade(SECTION, c);
 			}
-			// process the audio graph
-			out = algorithm[SECTION]->processGraph();
-			// each algorithm has a specific gain factor
-			out = out * programSelectorWithCV.getSection(SECTION).getCurrentProgramGain();
-
-			// if filters are active
-			if (!bypassFilters) {
-
-				// set parameters
-				const float freqCV = std::pow(params[CUTOFF_CV_PARAM].getValue(), 2) * inputs[CUTOFF_INPUT].getVoltage();
-				const float pitch = rescale(params[CUTOFF_PARAM].getValue(), 0, 1, -5.5, +5.5) + freqCV;
-				const float cutoff = clamp(dsp::FREQ_C4 * std::pow(2.f, pitch), 1.f, 20000.);
-				const float cutoffNormalised = clamp(cutoff / args.sampleRate, 0.f, 0.49f);
-				const float q = M_SQRT1_2 + std::pow(params[RES_PARAM].getValue(), 2) * 10.f;
-				const FilterMode mode = typeMappingSVF[(int) params[FILTER_TYPE_PARAM].getValue()];
-				svfFilter[SECTION].setParameters(cutoffNormalised, q);
-
-				// apply filter
-				svfFilter[SECTION].process(out);
-				// and retrieve relevant output
-				out = svfFilter[SECTION].output(mode);
+			outputs[OUTPUT].setVoltage(0.f);
+			return;
+		}
+
+		for (int c = 0; c < channels; c++) {
+			Voice& voice = voices[SECTION][c];
+			if (!voice.algorithm) {
+				continue;
 			}
 
-			if (blockDC) {
-				// cascaded Biquad (4th order highpass at ~20Hz)
-				out = blockDCFilter[SECTION].process(out);
+			// update parameters of the algorithm, with X/Y sampled as on the hardware; updates stay at the Teensy's
+			// loop rate whatever the block size, as some algorithms advance random walks once per update (in fast
+			// float mode, the primitives then ramp to the new values over the update period, rather than step)
+			if (updateParams) {
+				const float cvX = params[X_PARAM].getValue() + rescale(inputs[X_INPUT].getPolyVoltage(c), -10.f, +10.f, -1.f, 1.f);
+				const float cvY = params[Y_PARAM].getValue() + rescale(inputs[Y_INPUT].getPolyVoltage(c), -10.f, +10.f, -1.f, 1.f);
+				if (renderAhead) {
+					voice.pendingX = clamp(cvX, 0.f, 1.f);
+					voice.pendingY = clamp(cvY, 0.f, 1.f);
+					voice.updatePending = true;
+				}
+				else {
+					voice.algorithm->process(clamp(cvX, 0.f, 1.f), clamp(cvY, 0.f, 1.f));
+					if (voice.fadingAlgorithm) {
+						voice.fadingAlgorithm->process(clamp(cvX, 0.f, 1.f), clamp(cvY, 0.f, 1.f));
+					}
+				}
 			}
 		}
 
-		outputs[OUTPUT].setVoltage(Saturator<float>::process(out) * 5.f);
+		// process the audio graphs
+		if (renderAhead) {
+			renderBlocksAhead(SECTION, channels);
+		}
+		else {
+			renderBlocks(SECTION, channels);
+		}
+		blockPosition[SECTION] = (blockPosition[SECTION] + 1) % blockSize;
+
+		for (int c = 0; c < channels; c++) {
+			Voice& voice = voices[SECTION][c];
+			float out = 0.f;
+			if (voice.algorithm) {
+				// each algorithm has a specific gain factor
+				out = voice.algorithm->processGraph() * voice.gain;
+
+				// equal power, as the algorithms are uncorrelated
+				if (voice.fadingAlgorithm && voice.crossfade < 1.f) {
+					const float phase = 0.5f * M_PI * voice.crossfade;
+					out = out * std::sin(phase) + voice.fadingAlgorithm->processGraph() * voice.fadingGain * std::cos(phase);
+					voice.crossfade += args.sampleTime / crossfadeTimeSecs;
+				}
+				// (when rendering ahead, the faded out algorithm is released at the end of the block)
+				if (voice.fadingAlgorithm && voice.crossfade >= 1.f && !renderAhead) {
+					endCrossfade(SECTION, c);
+				}
+
+				// if filters are active
+				if (!bypassFilters) {
+
+					// set parameters
+					const float freqCV = std::pow(params[CUTOFF_CV_PARAM].getValue(), 2) * inputs[CUTOFF_INPUT].getPolyVoltage(c);
+					const float pitch = rescale(params[CUTOFF_PARAM].getValue(), 0, 1, -5.5, +5.5) + freqCV;
+					const float cutoff = clamp(dsp::FREQ_C4 * std::pow(2.f, pitch), 1.f, 20000.);
+					const float cutoffNormalised = clamp(cutoff / args.sampleRate, 0.f, 0.49f);
+					const float q = M_SQRT1_2 + std::pow(params[RES_PARAM].getValue(), 2) * 10.f;
+					const FilterMode mode = typeMappingSVF[(int) params[FILTER_TYPE_PARAM].getValue()];
+					voice.svfFilter.setParameters(cutoffNormalised, q);
+
+					// apply filter
+					voice.svfFilter.process(out);
+					// and retrieve relevant output
+					out = voice.svfFilter.output(mode);
+				}
+
+				if (blockDC) {
+					// cascaded Biquad (4th order highpass at ~20Hz)
+					out = voice.blockDCFilter.process(out);
+				}
+			}
+
+			outputs[OUTPUT].setVoltage(Saturator<float>::process(out) * 5.f, c);
+		}
 	}
 
 	// process section C
@@ -406,7 +724,7 @@ struct NoisePlethora : Module {
 
 			if (blockDC) {
 				// cascaded Biquad (4th order highpass at ~20Hz)
-				out = blockDCFilter[SECTION_C].process(out);
+				out = blockDCFilterC.process(out);
 			}
 		}
 		else if (bypassFilters) {
@@ -507,10 +825,9 @@ struct NoisePlethora : Module {
 	void setAlgorithmViaProgram(int newProgram) {
 
 		const int currentBank = programSelector.getCurrent().getBank();
-		std::string_view algorithmName = getBankForIndex(currentBank).getProgramName(newProgram);
 		const int section = programSelector.getMode();
 
-		setAlgorithm(section, algorithmName);
+		setAlgorithm(section, currentBank, newProgram);
 	}
 
 	void setAlgorithmViaBank(int newBank) {
@@ -518,12 +835,26 @@ struct NoisePlethora : Module {
 		const int currentProgram = programSelector.getCurrent().getProgram();
 		// the new bank may not have as many algorithms
 		const int currentProgramInNewBank = clamp(currentProgram, 0, getBankForIndex(newBank).getSize() - 1);
-		const std::string_view algorithmName = getBankForIndex(newBank).getProgramName(currentProgramInNewBank);
 		const int section = programSelector.getMode();
 
+		setAlgorithm(section, newBank, currentProgramInNewBank);
+	}
+
+	// as setAlgorithm, but for use outside of the audio thread (UI, patch loading), so also creates the
+	// algorithm now if it isn't cached, to avoid a gap before it's created in the background
+	void loadAlgorithm(int section, std::string_view algorithmName) {
+		if (section > 1) {
+			return;
+		}
 		setAlgorithm(section, algorithmName);
+		// for each voice in use, others load on demand
+		ProgramSelection& selection = programSelector.getSection(section);
+		for (int c = 0; c < numVoices[section]; c++) {
+			algorithmPool[section][c].preload(getProgramId(selection.getBank(), selection.getProgram()));
+		}
 	}
 
+	// by name (patches, UI), looked up in the banks
 	void setAlgorithm(int section, std::string_view algorithmName) {
 
 		if (section > 1) {
@@ -533,10 +864,7 @@ struct NoisePlethora : Module {
 		for (int bank = 0; bank < numBanks; ++bank) {
 			for (int program = 0; program < getBankForIndex(bank).getSize(); ++program) {
 				if (getBankForIndex(bank).getProgramName(program) == algorithmName) {
-					programSelector.setMode(section);
-					programSelector.getCurrent().setBank(bank);
-					programSelector.getCurrent().setProgram(program);
-
+					setAlgorithm(section, bank, program);
 					return;
 				}
 			}
@@ -545,15 +873,27 @@ struct NoisePlethora : Module {
 		DEBUG("WARNING: Didn't find %s in programSelector", algorithmName.data());
 	}
 
+	void setAlgorithm(int section, int bank, int program) {
+		programSelector.setMode(section);
+		programSelector.getCurrent().setBank(bank);
+		programSelector.getCurrent().setProgram(program);
+	}
+
 	void dataFromJson(json_t* rootJ) override {
+		// (before the algorithms are loaded)
+		json_t* seedJ = json_object_get(rootJ, "seed");
+		if (seedJ) {
+			setSeed((uint64_t) json_integer_value(seedJ));
+		}
+
 		json_t* bankAJ = json_object_get(rootJ, "algorithmA");
 		if (bankAJ) {
-			setAlgorithm(SECTION_A, json_string_value(bankAJ));
+			loadAlgorithm(SECTION_A, json_string_value(bankAJ));
 		}
 
 		json_t* bankBJ = json_object_get(rootJ, "algorithmB");
 		if (bankBJ) {
-			setAlgorithm(SECTION_B, json_string_value(bankBJ));
+			loadAlgorithm(SECTION_B, json_string_value(bankBJ));
 		}
 
 		json_t* bypassFiltersJ = json_object_get(rootJ, "bypassFilters");
@@ -565,6 +905,39 @@ struct NoisePlethora : Module {
 		if (blockDCJ) {
 			blockDC = json_boolean_value(blockDCJ);
 		}
+
+		json_t* processingModeJ = json_object_get(rootJ, "processingMode");
+		if (processingModeJ) {
+			processingMode = (teensy::ProcessingMode) clamp((int) json_integer_value(processingModeJ), 0, teensy::NUM_PROCESSING_MODES - 1);
+		}
+
+		json_t* polyphonicJ = json_object_get(rootJ, "polyphonic");
+		if (polyphonicJ) {
+			polyphonic = json_boolean_value(polyphonicJ);
+		}
+
+		json_t* renderAheadJ = json_object_get(rootJ, "renderAhead");
+		if (renderAheadJ) {
+			setRenderAhead(json_boolean_value(renderAheadJ));
+		}
+
+		json_t* profileProgramsJ = json_object_get(rootJ, "profilePrograms");
+		if (profileProgramsJ) {
+			profilePrograms = json_boolean_value(profileProgramsJ);
+		}
+
+		json_t* blockSizeJ = json_object_get(rootJ, "blockSize");
+		if (blockSizeJ) {
+			const int size = json_integer_value(blockSizeJ);
+			blockSize = std::count(blockSizes, blockSizes + NUM_BLOCK_SIZES, size) ? size : AUDIO_BLOCK_SAMPLES;
+		}
+	}
+
+	// e.g. "210ns, 340ns (0.9% CPU)"
+	std::string getProfileText(int program) {
+		const float meanNs = programProfiler.getMeanNs(program);
+		return string::f("%.0fns, %.0fns (%.1f%% CPU)", meanNs,
+		                 programProfiler.getPercentileNs(program, 0.95f), ProgramProfiler::getCpuPercent(meanNs, APP->engine->getSampleRate()));
 	}
 
 	json_t* dataToJson() override {
@@ -575,6 +948,16 @@ struct NoisePlethora : Module {
 
 		json_object_set_new(rootJ, "bypassFilters", json_boolean(bypassFilters));
 		json_object_set_new(rootJ, "blockDC", json_boolean(blockDC));
+		json_object_set_new(rootJ, "processingMode", json_integer(processingMode));
+		json_object_set_new(rootJ, "blockSize", json_integer(blockSize));
+		json_object_set_new(rootJ, "polyphonic", json_boolean(polyphonic));
+		json_object_set_new(rootJ, "renderAhead", json_boolean(renderAhead));
+		json_object_set_new(rootJ, "seed", json_integer((json_int_t) seed));
+		json_object_set_new(rootJ, "profilePrograms", json_boolean(profilePrograms));
+		// (measurements only, not read back)
+		if (profilePrograms) {
+			json_object_set_new(rootJ, "programProfile", programProfiler.toJson(APP->engine->getSampleRate()));
+		}
 
 		return rootJ;
 	}
@@ -656,6 +1039,12 @@ struct NoisePlethoraLEDDisplay : LightWidget {
 		std::string_view activeName = module->programSelector.getSection(section).getCurrentProgramName();
 		tooltip = new ui::Tooltip;
 		tooltip->text = activeName;
+		// and what it costs, if profiling
+		ProgramSelection& selection = module->programSelector.getSection(section);
+		const int program = getProgramId(selection.getBank(), selection.getProgram());
+		if (module->profilePrograms && module->programProfiler.hasData(program)) {
+			tooltip->text += "\n" + module->getProfileText(program) + " per sample";
+		}
 		APP->scene->addChild(tooltip);
 	}
 
@@ -846,24 +1235,10 @@ struct NoisePlethoraWidget : ModuleWidget {
 							const bool currentProgramAndBank = (currentProgram == j) && (currentBank == i);
 							std::string_view algorithmName = getBankForIndex(i).getProgramName(j);
 
-							bool implemented = false;
-							for (auto item : MyFactory::Instance()->factoryFunctionRegistry) {
-								if (item.first == algorithmName) {
-									implemented = true;
-									break;
-								}
-							}
-
-							if (implemented) {
-								menu->addChild(createMenuItem(algorithmName.data(), currentProgramAndBank ? CHECKMARK_STRING : "",
-								[ = ]() {
-									module->setAlgorithm(sectionId, algorithmName);
-								}));
-							}
-							else {
-								// placeholder text (greyed out)
-								menu->addChild(createMenuLabel(algorithmName.data()));
-							}
+							menu->addChild(createMenuItem(algorithmName.data(), currentProgramAndBank ? CHECKMARK_STRING : "",
+							[ = ]() {
+								module->loadAlgorithm(sectionId, algorithmName);
+							}));
 						}
 					}));
 				}
@@ -872,6 +1247,58 @@ struct NoisePlethoraWidget : ModuleWidget {
 
 		}
 
+		menu->addChild(createIndexSubmenuItem("Teensy arithmetic",
+		{"Hardware-exact (fixed point)", "Fast float"},
+		[ = ]() {
+			return module->processingMode;
+		},
+		[ = ](int mode) {
+			module->processingMode = (teensy::ProcessingMode) mode;
+		}));
+
+		menu->addChild(createIndexSubmenuItem("Block size",
+		{"8 samples", "16 samples", "32 samples", "64 samples", "128 samples (hardware)"},
+		[ = ]() {
+			return std::find(module->blockSizes, module->blockSizes + NoisePlethora::NUM_BLOCK_SIZES, module->blockSize) - module->blockSizes;
+		},
+		[ = ](int index) {
+			module->blockSize = module->blockSizes[index];
+		}));
+
+		menu->addChild(createBoolPtrMenuItem("Polyphonic (voice per X, Y, program or cutoff CV channel)", "", &module->polyphonic));
+
+		menu->addChild(createBoolMenuItem("Render A and B ahead on worker threads", "",
+		[ = ]() {
+			return module->renderAhead;
+		},
+		[ = ](bool enabled) {
+			module->setRenderAhead(enabled);
+		}));
+
+		menu->addChild(createBoolMenuItem("Profile programs", "",
+		[ = ]() {
+			return module->profilePrograms;
+		},
+		[ = ](bool enabled) {
+			module->profilePrograms = enabled;
+			module->programProfiler.reset();
+		}));
+		if (module->profilePrograms) {
+			menu->addChild(createSubmenuItem("Program CPU (per sample: mean, 95th percentile)", "",
+			[ = ](Menu * menu) {
+				bool any = false;
+				for (int program = 0; program < numPrograms; program++) {
+					if (module->programProfiler.hasData(program)) {
+						menu->addChild(createMenuLabel(string::f("%s: %s", getProgramNameForId(program).data(), module->getProfileText(program).c_str())));
+						any = true;
+					}
+				}
+				if (!any) {
+					menu->addChild(createMenuLabel("No programs played yet"));
+				}
+			}));
+		}
+
 		menu->addChild(createMenuLabel("Filters"));
 		menu->addChild(createBoolPtrMenuItem("Remove DC", "", &module->blockDC));
 		menu->addChild(createBoolPtrMenuItem("Bypass Filters", "", &module->bypassFilters));
@@ -1,5 +1,7 @@
 #include "plugin.hpp"
 #include "ChowDSP.hpp"
+#include "PolyBLEP.hpp"
+#include "BandlimitedTables.hpp"
 
 using namespace simd;
 
@@ -53,6 +55,19 @@ struct Octaves : Module {
 	float_4 phase[4] = {};		// phase for core waveform, in [0, 1]
 	chowdsp::VariableOversampling<6, float_4> oversampler[NUM_OUTPUTS][4]; 	// uses a 2*6=12th order Butterworth filter
 	int oversamplingIndex = 2; 	// default is 2^oversamplingIndex == x4 oversampling
+	chowdsp::OversamplingChangeFader oversamplingFader; 	// fades outputs while oversampling settings change
+	chowdsp::OversamplingFilterType oversamplingFilter = chowdsp::IIR_FILTER; 	// low latency IIR or linear phase FIR
+
+	enum OscillatorEngine {
+		NAIVE_ENGINE, 		// naive waveforms, oversampled
+		POLYBLEP_ENGINE, 	// naive waveforms with polyBLEP / polyBLAMP residuals, at the base sample rate
+		WAVETABLE_ENGINE, 	// mip-mapped band-limited tables, at the base sample rate
+		NUM_ENGINES
+	};
+	OscillatorEngine oscillatorEngine = NAIVE_ENGINE;
+	OscillatorEngine activeEngine = NAIVE_ENGINE; 	// changes with the oversampling settings, i.e. once faded out
+
+	const wavetable::BandlimitedTables& tables = wavetable::BandlimitedTables::get();
 
 	DCBlockerT<2, float_4> blockDCFilter[NUM_OUTPUTS][4];			// optionally block DC with RC filter @ ~22 Hz
 	dsp::TSchmittTrigger<float_4> syncTrigger[4]; 	// for hard sync
@@ -100,23 +115,43 @@ struct Octaves : Module {
 
 	void onSampleRateChange() override {
 		float sampleRate = APP->engine->getSampleRate();
+		oversamplingFader.reset(sampleRate);
+		activeEngine = oscillatorEngine;
 		for (int c = 0; c < NUM_OUTPUTS; c++) {
 			for (int i = 0; i < 4; i++) {
-				oversampler[c][i].setOversamplingIndex(oversamplingIndex);
+				// polyBLEP and wavetables run at the base rate, whatever the oversampling settings
+				oversampler[c][i].setOversamplingIndex(activeEngine == NAIVE_ENGINE ? oversamplingIndex : 0);
+				oversampler[c][i].setFilterType(oversamplingFilter);
 				oversampler[c][i].reset(sampleRate);
 				blockDCFilter[c][i].setFrequency(22.05 / sampleRate);
 			}
 		}
 	}
 
+	// prepare the oversamplers for the settings chosen in the context menu (UI thread), then fade over the change
+	void requestOversamplingChange() {
+		for (int c = 0; c < NUM_OUTPUTS; c++) {
+			for (int i = 0; i < 4; i++) {
+				oversampler[c][i].prepare(oscillatorEngine == NAIVE_ENGINE ? oversamplingIndex : 0, oversamplingFilter);
+			}
+		}
+		oversamplingFader.requestChange();
+	}
+
 
 	void process(const ProcessArgs& args) override {
 
+		// apply any pending change of oversampling settings, once the outputs have faded out
+		if (oversamplingFader.process()) {
+			onSampleRateChange();
+		}
+		const float outputGain = 5.f * oversamplingFader.getGain();
+
 		const int numActivePolyphonyEngines = getNumActivePolyphonyEngines();
 
-		// work out active outputs
-		const int highestOutput = getMaxConnectedOutput();
-		if (highestOutput == -1) {
+		// work out which octaves feed which outputs
+		updateRoutes();
+		if (numRoutes == 0) {
 			return;
 		}
 
@@ -142,65 +177,100 @@ struct Octaves : Module {
 			phase[c / 4] = simd::ifelse(sync, 0.5f, phase[c / 4]);
 
 
-			for (int i = 0; i < oversamplingRatio; i++) {
-
-				phase[c / 4] += deltaPhase;
-				phase[c / 4] -= simd::floor(phase[c / 4]);
-
-				float_4 sum = {};
-				for (int oct = 0; oct <= highestOutput; oct++) {
-
+			// the octaves to compute (for each route, those with non-zero gain), with their gains and step sizes
+			int octaves[NUM_OUTPUTS];
+			float_4 gains[NUM_OUTPUTS];
+			float_4 octaveDeltaPhases[NUM_OUTPUTS];
+			int routeEnd[NUM_OUTPUTS]; 	// each route's octaves end here
+			int numOctaves = 0;
+			for (int r = 0; r < numRoutes; r++) {
+				for (int oct = routes[r].firstOctave; oct <= routes[r].output; oct++) {
 					const float_4 gainCV = simd::clamp(inputs[GAIN_01F_INPUT + oct].getNormalPolyVoltageSimd<float_4>(10.f, c) / 10.f, 0.f, 1.0f);
 					const float_4 gain = params[GAIN_01F_PARAM + oct].getValue() * gainCV;
 
-					// don't bother processing if gain is zero and no output is connected
-					const bool isGainZero = simd::movemask(gain != 0.f) == 0; 
-					if (isGainZero && !outputs[OUT_01F_OUTPUT + oct].isConnected()) {
-						continue;
+					// don't bother processing if gain is zero (it adds nothing to the sum)
+					if (simd::movemask(gain != 0.f) != 0) {
+						octaves[numOctaves] = oct;
+						gains[numOctaves] = gain;
+						octaveDeltaPhases[numOctaves] = (float)(1 << oct) * deltaPhase;
+						numOctaves++;
 					}
+				}
+				routeEnd[r] = numOctaves;
+			}
 
-					// derive phases for higher octaves from base phase (this keeps things in sync!)
-					const float_4 n = (float)(1 << oct);
-					// this is on [0, 1]
-					const float_4 effectivePhase = n * simd::fmod(phase[c / 4], 1 / n);
-					const float_4 waveTri = 1.0 - 2.0 * simd::abs(2.f * effectivePhase - 1.0);
-					// build square from triangle + comparator
-					const float_4 waveSquare = simd::ifelse(waveTri > pwm, +1.f, -1.f);
-
-					sum += (useTriangleCore ? waveTri : waveSquare) * gain;
-					sum = clamp(sum, -1.f, 1.f);
+			for (int i = 0; i < oversamplingRatio; i++) {
 
-					if (outputs[OUT_01F_OUTPUT + oct].isConnected()) {
-						oversampler[oct][c/4].getOSBuffer()[i] = sum;
-						sum = 0.f;
+				phase[c / 4] += deltaPhase;
+				phase[c / 4] -= simd::floor(phase[c / 4]);
 
-						// DEBUG("here %f %f %f %f %f", phase[c/4][0], waveTri[0], sum[0], gain[0], gainCV[0]);
+				int k = 0;
+				for (int r = 0; r < numRoutes; r++) {
+					float_4 sum = {};
+					for (; k < routeEnd[r]; k++) {
+						// derive phases for higher octaves from base phase (this keeps things in sync!)
+						const float_4 scaledPhase = (float)(1 << octaves[k]) * phase[c / 4];
+						// this is on [0, 1]
+						const float_4 effectivePhase = scaledPhase - simd::floor(scaledPhase);
+						sum += getWaveform(effectivePhase, octaveDeltaPhases[k], pwm) * gains[k];
+						sum = clamp(sum, -1.f, 1.f);
 					}
-
-					
-
+					oversampler[routes[r].output][c / 4].getOSBuffer()[i] = sum;
 				}
 
 			} // end of oversampling loop
 
 			// only downsample required channels
-			for (int oct = 0; oct <= highestOutput; oct++) {
-				if (outputs[OUT_01F_OUTPUT + oct].isConnected()) {
-
-					// downsample (if required)
-					float_4 out = (oversamplingRatio > 1) ? oversampler[oct][c/4].downsample() : oversampler[oct][c/4].getOSBuffer()[0];
-					if (removePulseDC) {
-						out = blockDCFilter[oct][c/4].process(out);
-					}
+			for (int r = 0; r < numRoutes; r++) {
+				const int oct = routes[r].output;
 
-					outputs[OUT_01F_OUTPUT + oct].setVoltageSimd(5.f * out, c);					
+				// downsample (if required)
+				float_4 out = (oversamplingRatio > 1) ? oversampler[oct][c / 4].downsample() : oversampler[oct][c / 4].getOSBuffer()[0];
+				if (removePulseDC) {
+					out = blockDCFilter[oct][c / 4].process(out);
 				}
+
+				outputs[OUT_01F_OUTPUT + oct].setVoltageSimd(outputGain * out, c);
 			}
 		}	// end of polyphony loop
 
-		for (int c = 0; c < NUM_OUTPUTS; c++) {
-			if (outputs[OUT_01F_OUTPUT + c].isConnected()) {
-				outputs[OUT_01F_OUTPUT + c].setChannels(numActivePolyphonyEngines);
+		for (int r = 0; r < numRoutes; r++) {
+			outputs[OUT_01F_OUTPUT + routes[r].output].setChannels(numActivePolyphonyEngines);
+		}
+	}
+
+	// one octave's triangle or square (at phase in [0, 1], advancing by deltaPhase per step) from the active engine
+	float_4 getWaveform(float_4 phase, float_4 deltaPhase, float_4 pwm) {
+		// the triangle crosses pwm on the way up at phase (1 + pwm) / 4, and on the way down at 1 minus that
+		const float_4 risingEdge = 0.25f * (1.f + pwm);
+
+		switch (activeEngine) {
+			case WAVETABLE_ENGINE: {
+				// the tables only hold up to Nyquist, higher octaves are silenced
+				const float_4 belowNyquist = deltaPhase < 0.5f;
+				if (useTriangleCore) {
+					return simd::ifelse(belowNyquist, tables.tri(phase, deltaPhase), 0.f);
+				}
+				// the square as the difference of two saws, which have steps down at each edge (and DC of -pwm between them)
+				const float_4 saws = tables.saw(polyblep::offsetPhase(phase, 1.f - risingEdge), deltaPhase) - tables.saw(polyblep::offsetPhase(phase, risingEdge), deltaPhase);
+				return simd::ifelse(belowNyquist, saws - pwm, 0.f);
+			}
+			case POLYBLEP_ENGINE: {
+				// the residuals only hold up to Nyquist, higher octaves are silenced
+				const float_4 belowNyquist = deltaPhase < 0.5f;
+				const float_4 waveTri = 1.0 - 2.0 * simd::abs(2.f * phase - 1.0);
+				if (useTriangleCore) {
+					const float_4 corners = polyblep::blamp(phase, deltaPhase) - polyblep::blamp(polyblep::offsetPhase(phase, float_4(0.5f)), deltaPhase);
+					return simd::ifelse(belowNyquist, waveTri + 8.f * corners, 0.f);
+				}
+				const float_4 waveSquare = simd::ifelse(waveTri > pwm, +1.f, -1.f);
+				const float_4 edges = polyblep::blep(polyblep::offsetPhase(phase, risingEdge), deltaPhase) - polyblep::blep(polyblep::offsetPhase(phase, 1.f - risingEdge), deltaPhase);
+				return simd::ifelse(belowNyquist, waveSquare + 2.f * edges, 0.f);
+			}
+			default: {
+				const float_4 waveTri = 1.0 - 2.0 * simd::abs(2.f * phase - 1.0);
+				// build square from triangle + comparator
+				return useTriangleCore ? waveTri : simd::ifelse(waveTri > pwm, +1.f, -1.f);
 			}
 		}
 	}
@@ -219,22 +289,44 @@ struct Octaves : Module {
 		return activePolyphonyEngines;
 	}
 
-	int getMaxConnectedOutput() {
-		int maxChans = -1;
-		for (int c = 0; c < NUM_OUTPUTS; c++) {
-			if (outputs[OUT_01F_OUTPUT + c].isConnected()) {
-				maxChans = c;
+	// each connected output carries the (clamped) sum of its own octave and those of the unconnected outputs below it,
+	// worked out whenever connections change; octaves above the highest connected output aren't computed
+	struct Route {
+		int output;
+		int firstOctave;
+	};
+	Route routes[NUM_OUTPUTS];
+	int numRoutes = 0;
+	int routesKey = -1; 	// connected outputs the routes were worked out for
+
+	void updateRoutes() {
+		int key = 0;
+		for (int oct = 0; oct < NUM_OUTPUTS; oct++) {
+			key |= outputs[OUT_01F_OUTPUT + oct].isConnected() << oct;
+		}
+		if (key == routesKey) {
+			return;
+		}
+
+		routesKey = key;
+		numRoutes = 0;
+		int firstOctave = 0;
+		for (int oct = 0; oct < NUM_OUTPUTS; oct++) {
+			if (outputs[OUT_01F_OUTPUT + oct].isConnected()) {
+				routes[numRoutes++] = {oct, firstOctave};
+				firstOctave = oct + 1;
 			}
 		}
-		return maxChans;
 	}
 
 	json_t* dataToJson() override {
 		json_t* rootJ = json_object();
 		json_object_set_new(rootJ, "removePulseDC", json_boolean(removePulseDC));
 		json_object_set_new(rootJ, "limitPW", json_boolean(limitPW));
-		json_object_set_new(rootJ, "oversamplingIndex", json_integer(oversampler[0][0].getOversamplingIndex()));
+		json_object_set_new(rootJ, "oversamplingIndex", json_integer(oversamplingIndex));
+		json_object_set_new(rootJ, "oversamplingFilter", json_integer(oversamplingFilter));
 		json_object_set_new(rootJ, "useTriangleCore", json_boolean(useTriangleCore));
+		json_object_set_new(rootJ, "oscillatorEngine", json_integer(oscillatorEngine));
 
 		return rootJ;
 	}
@@ -251,6 +343,18 @@ struct Octaves : Module {
 			limitPW = json_boolean_value(limitPWJ);
 		}
 
+		json_t* oscillatorEngineJ = json_object_get(rootJ, "oscillatorEngine");
+		if (oscillatorEngineJ) {
+			oscillatorEngine = (OscillatorEngine) clamp((int) json_integer_value(oscillatorEngineJ), 0, NUM_ENGINES - 1);
+			onSampleRateChange();
+		}
+
+		json_t* oversamplingFilterJ = json_object_get(rootJ, "oversamplingFilter");
+		if (oversamplingFilterJ) {
+			oversamplingFilter = (chowdsp::OversamplingFilterType) json_integer_value(oversamplingFilterJ);
+			onSampleRateChange();
+		}
+
 		json_t* oversamplingIndexJ = json_object_get(rootJ, "oversamplingIndex");
 		if (oversamplingIndexJ) {
 			oversamplingIndex = json_integer_value(oversamplingIndexJ);
@@ -319,6 +423,17 @@ struct OctavesWidget : ModuleWidget {
 		}
 		                                ));
 
+		menu->addChild(createIndexSubmenuItem("Oscillator engine",
+		{"Naive (oversampled)", "PolyBLEP (no oversampling)", "Band-limited wavetables (no oversampling)"},
+		[ = ]() {
+			return module->oscillatorEngine;
+		},
+		[ = ](int mode) {
+			module->oscillatorEngine = (Octaves::OscillatorEngine) mode;
+			module->requestOversamplingChange();
+		}
+		                                     ));
+
 		menu->addChild(createIndexSubmenuItem("Oversampling",
 		{"Off", "x2", "x4", "x8"},
 		[ = ]() {
@@ -326,7 +441,18 @@ struct OctavesWidget : ModuleWidget {
 		},
 		[ = ](int mode) {
 			module->oversamplingIndex = mode;
-			module->onSampleRateChange();
+			module->requestOversamplingChange();
+		}
+		                                     ));
+
+		menu->addChild(createIndexSubmenuItem("Oversampling filter",
+		{"Low latency (IIR)", "High quality (FIR)"},
+		[ = ]() {
+			return module->oversamplingFilter;
+		},
+		[ = ](int mode) {
+			module->oversamplingFilter = (chowdsp::OversamplingFilterType) mode;
+			module->requestOversamplingChange();
 		}
 		                                     ));
 
@@ -0,0 +1,564 @@
+#pragma once
+#include <rack.hpp>
+#include <pffft.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include "RenderWorkers.hpp"
+
+/**
+ * Zero latency convolution with a long kernel, processed a sample at a time.
+ *
+ * The kernel is split non-uniformly (see W. G. Gardner, "Efficient Convolution without Input-Output
+ * Delay", JAES 1995): the first 2 * headSize taps are applied directly as an FIR, then each level of FFT
+ * partitions doubles in block size. A level with block size B covers kernel taps [2B, 4B), except the
+ * last (B = maxBlockSize) which covers the remainder of the kernel with uniform partitions. As a block's
+ * output isn't due until B samples after its input is complete, the FFT work for each block is split into
+ * tasks (forward FFT, one complex multiply-accumulate per partition, inverse FFT) and spread over the
+ * following B calls to process(), instead of being done all at once at the block boundary. Every level's
+ * block boundaries fall on multiples of the largest block size, so each level's schedule is delayed by a
+ * few samples (its index, as far as its deadline allows), so their forward FFTs don't land on the same
+ * sample.
+ *
+ * Optionally (see setBackgroundThread()) the jobs of the largest levels, which hold nearly all of a long
+ * kernel's partitions, are instead posted to the worker threads shared by all instances (RenderWorkers.hpp)
+ * as each block completes, and collected at the next block boundary, so the audio thread only runs the
+ * direct head and the small levels.
+ *
+ * The kernel's partitions and their spectra are held in a Kernel, which is immutable once built, so can
+ * be shared by any number of convolvers using the same kernel.
+ *
+ * Several channels can be convolved with the same kernel. Each task then runs for all channels in turn
+ * (e.g. one partition's spectrum is multiplied with every channel's input spectrum before moving on to
+ * the next partition), so the kernel's spectra are read once per block, rather than once per channel.
+ *
+ * Changing the kernel or the number of channels builds new state off the audio thread, which process()
+ * swaps in with an atomic exchange, so the audio thread never allocates, frees, or starts or stops threads.
+ */
+class PartitionedConvolver {
+public:
+	/** A kernel split and transformed for a partition scheme (headSize, maxBlockSize as described above) */
+	class Kernel {
+	public:
+		Kernel(const float* kernel, size_t length, int headSize = 64, int maxBlockSize = 2048) : headLength(2 * headSize) {
+			assert(headSize >= 16 && (headSize & (headSize - 1)) == 0);
+			assert(maxBlockSize >= headSize && (maxBlockSize & (maxBlockSize - 1)) == 0);
+
+			// direct FIR taps, reversed so they line up with the (oldest first) history
+			headCoeffs = allocate(headLength);
+			for (size_t i = 0; i < std::min(length, (size_t) headLength); i++) {
+				headCoeffs[headLength - 1 - i] = kernel[i];
+			}
+
+			for (int blockSize = headSize; 2 * (size_t) blockSize < length; blockSize *= 2) {
+				const size_t offset = 2 * blockSize;
+				const size_t end = (blockSize == maxBlockSize) ? length : std::min(length, offset + 2 * blockSize);
+				levels.emplace_back(blockSize, &kernel[offset], end - offset);
+				if (blockSize == maxBlockSize) {
+					break;
+				}
+			}
+		}
+
+		~Kernel() {
+			pffft_aligned_free(headCoeffs);
+			for (LevelKernel& level : levels) {
+				pffft_aligned_free(level.spectra);
+				pffft_destroy_setup(level.setup);
+			}
+		}
+
+		Kernel(const Kernel&) = delete;
+		Kernel& operator=(const Kernel&) = delete;
+
+		/** Total number of FFT partitions (for diagnostics) */
+		int getNumPartitions() const {
+			int numPartitions = 0;
+			for (const LevelKernel& level : levels) {
+				numPartitions += level.numPartitions;
+			}
+			return numPartitions;
+		}
+
+	private:
+		friend class PartitionedConvolver;
+
+		struct LevelKernel {
+			int blockSize;
+			int fftSize;
+			int numPartitions;
+			PFFFT_Setup* setup; 	// pffft only reads its setup, so it's shared too
+			float* spectra; 		// numPartitions spectra, fftSize floats each (pffft's internal order)
+
+			LevelKernel(int blockSize, const float* kernel, size_t length) : blockSize(blockSize), fftSize(2 * blockSize) {
+				numPartitions = (length + blockSize - 1) / blockSize;
+				setup = pffft_new_setup(fftSize, PFFFT_REAL);
+				spectra = allocate(numPartitions * fftSize);
+
+				// each partition is zero padded to the FFT size
+				float* input = allocate(fftSize);
+				float* work = allocate(fftSize);
+				for (int p = 0; p < numPartitions; p++) {
+					std::fill(input, &input[fftSize], 0.f);
+					const size_t partitionLength = std::min((size_t) blockSize, length - p * blockSize);
+					std::copy_n(&kernel[p * blockSize], partitionLength, input);
+					pffft_transform(setup, input, &spectra[p * fftSize], work, PFFFT_FORWARD);
+				}
+				pffft_aligned_free(input);
+				pffft_aligned_free(work);
+			}
+		};
+
+		const int headLength;
+		float* headCoeffs;
+		std::vector<LevelKernel> levels;
+	};
+
+	PartitionedConvolver() {}
+
+	~PartitionedConvolver() {
+		for (State* built : states) {
+			delete built;
+		}
+	}
+
+	PartitionedConvolver(const PartitionedConvolver&) = delete;
+	PartitionedConvolver& operator=(const PartitionedConvolver&) = delete;
+
+	/**
+	 * Sets the kernel (which may be shared with other convolvers). Until a kernel is set, the output is
+	 * silent. Not for the audio thread: like setMaxChannels(), this builds new state (which starts from
+	 * silence), that process() swaps in at its next call.
+	 */
+	void setKernel(std::shared_ptr<const Kernel> newKernel) {
+		std::lock_guard<std::mutex> lock(controlMutex);
+		kernel = newKernel;
+		buildState();
+	}
+
+	/** Sets a kernel used only by this convolver */
+	void setKernel(const float* kernel, size_t length) {
+		setKernel(std::make_shared<const Kernel>(kernel, length));
+	}
+
+	/**
+	 * Runs the jobs of the largest levels on the shared worker threads, rather than spreading them over the
+	 * audio thread's calls to process(). Each job has until the end of the following block (at least
+	 * WORKER_MIN_BLOCK_SIZE samples), and if no worker has started it by then, the audio thread runs it
+	 * itself. Not for the audio thread, takes effect from each level's next block.
+	 */
+	void setBackgroundThread(bool enabled) {
+		std::lock_guard<std::mutex> lock(controlMutex);
+		if (enabled) {
+			for (State* built : states) {
+				built->enableJobs(true);
+			}
+			backgroundThread = true;
+		}
+		else {
+			// any job still queued is picked up by the audio thread at its deadline
+			backgroundThread = false;
+			for (State* built : states) {
+				built->enableJobs(false);
+			}
+		}
+	}
+
+	/**
+	 * Sets the number of channels state is held for. Not for the audio thread: the state is built here, and
+	 * swapped in (starting from silence) by process() at its next call, and the state it replaces is freed
+	 * by a later call to any of these setters, or by freeUnusedState().
+	 */
+	void setMaxChannels(int newMaxChannels) {
+		assert(newMaxChannels >= 1);
+		std::lock_guard<std::mutex> lock(controlMutex);
+		maxChannels = newMaxChannels;
+		buildState();
+	}
+
+	/**
+	 * Not for the audio thread: frees state that process() has swapped out. Doesn't wait for a setter running
+	 * on another thread (e.g. building state for a new kernel), so is cheap enough to call every UI frame.
+	 * Returns whether process() has swapped in the state built by the last setter, and the rest is freed.
+	 */
+	bool freeUnusedState() {
+		std::unique_lock<std::mutex> lock(controlMutex, std::try_to_lock);
+		if (!lock.owns_lock()) {
+			return false;
+		}
+		freeUnusedStates();
+		return states.size() <= 1 && nextState.load() == nullptr;
+	}
+
+	/**
+	 * Sets the number of channels processed (up to the max channels), without allocating. Channels that are
+	 * added start from silence.
+	 */
+	void setChannels(int newChannels) {
+		requestedChannels = newChannels;
+		if (!state) {
+			return;
+		}
+		newChannels = clamp(newChannels, 1, state->maxChannels);
+		if (newChannels == channels) {
+			return;
+		}
+		if (newChannels > channels) {
+			const int headLength = state->kernel->headLength;
+			for (int c = channels; c < newChannels; c++) {
+				std::fill(&state->headHistory[c * 2 * headLength], &state->headHistory[(c + 1) * 2 * headLength], 0.f);
+			}
+		}
+		for (Level* level : state->levels) {
+			level->setChannels(channels, newChannels);
+		}
+		channels = newChannels;
+	}
+
+	int getChannels() const {
+		return channels;
+	}
+
+	/** Clears all internal state (but not the kernel). Not to be called concurrently with process(). */
+	void reset() {
+		if (!state) {
+			return;
+		}
+		std::fill(state->headHistory, &state->headHistory[state->maxChannels * 2 * state->kernel->headLength], 0.f);
+		state->headPos = 0;
+		for (Level* level : state->levels) {
+			level->reset();
+		}
+	}
+
+	/** Convolves a single sample of each channel, `in` and `out` hold getChannels() samples */
+	inline void process(const float* in, float* out) {
+		if (nextState.load(std::memory_order_relaxed)) {
+			swapState();
+		}
+		if (!state) {
+			std::fill(out, &out[channels], 0.f);
+			return;
+		}
+
+		// direct FIR for the head of the kernel, history stored twice so the window never wraps
+		const int headLength = state->kernel->headLength;
+		const float* headCoeffs = state->kernel->headCoeffs;
+		const int headPos = state->headPos = (state->headPos + 1 == headLength) ? 0 : state->headPos + 1;
+		for (int c = 0; c < channels; c++) {
+			float* history = &state->headHistory[c * 2 * headLength];
+			history[headPos] = history[headPos + headLength] = in[c];
+			const float* window = &history[headPos + 1];
+			simd::float_4 sum = 0.f;
+			for (int i = 0; i < headLength; i += 4) {
+				sum += simd::float_4::load(&window[i]) * simd::float_4::load(&headCoeffs[i]);
+			}
+			out[c] = sum[0] + sum[1] + sum[2] + sum[3];
+		}
+
+		const bool offload = backgroundThread.load(std::memory_order_relaxed);
+		for (Level* level : state->levels) {
+			level->process(in, out, offload);
+		}
+	}
+
+	/** Convolves a single sample of the first channel */
+	inline float process(float x) {
+		float y;
+		process(&x, &y);
+		return y;
+	}
+
+	/** Total number of FFT partitions (for diagnostics) */
+	int getNumPartitions() {
+		std::lock_guard<std::mutex> lock(controlMutex);
+		return kernel ? kernel->getNumPartitions() : 0;
+	}
+
+	// smallest block size (i.e. deadline, in samples) of levels that are run on the background thread
+	static const int WORKER_MIN_BLOCK_SIZE = 1024;
+
+private:
+	static float* allocate(int size) {
+		float* buffer = (float*) pffft_aligned_malloc(sizeof(float) * size);
+		std::fill(buffer, &buffer[size], 0.f);
+		return buffer;
+	}
+
+	/** Uniformly partitioned (overlap-save) convolution with block size B, whose work is spread over B samples */
+	struct Level {
+		const int blockSize;
+		const int fftSize;
+		const int numPartitions;
+		const int numTasks;
+		const int phase; 		// samples the task schedule is delayed by within each block
+
+		PFFFT_Setup* const setup;
+		const float* const kernelSpectra;
+		const int maxChannels;
+		int channels = 1;
+
+		// per channel state is stored contiguously for each channel (so e.g. inputSpectra is
+		// [slot][channel][fftSize]), buffers without a channel are scratch space shared by all channels
+		float* inputSpectra; 		// ring of the last numPartitions input spectra
+		float* window; 				// previous and current input blocks
+		float* fftInput; 			// copy of window, taken when a block completes
+		float* accumulator;
+		float* fftOutput;
+		float* work;
+		float* ready; 				// output being played back
+		float* pending; 			// output being computed
+
+		int pos = 0; 			// position in current block
+		int spectrumPos = 0; 	// newest input spectrum
+		int task = 0; 			// next task of the pending job
+
+		// hand-off of a whole job to the workers: the audio thread posts it, and then at the deadline either
+		// waits for a worker to finish it, or runs it if none has started it
+		struct Job : RenderJob {
+			Level* level;
+			explicit Job(Level* level) : level(level) {}
+			void run() override {
+				level->runJob();
+			}
+		};
+		Job job{this};
+		bool offloadable = false;
+		bool jobOffloaded = false; 	// pending job belongs to the workers (audio thread only)
+
+		Level(const Kernel::LevelKernel& kernel, int index, int maxChannels, int channels) : blockSize(kernel.blockSize),
+			fftSize(kernel.fftSize), numPartitions(kernel.numPartitions),
+			// forward FFT, one multiply-accumulate per partition, inverse FFT
+			numTasks(kernel.numPartitions + 2),
+			// the last task must still run by the block's last sample, so the delay is less than the task spacing
+			phase(std::min(index, (blockSize + numTasks - 1) / numTasks - 1)), setup(kernel.setup), kernelSpectra(kernel.spectra), maxChannels(maxChannels),
+			channels(channels) {
+			inputSpectra = allocate(numPartitions * maxChannels * fftSize);
+			window = allocate(maxChannels * fftSize);
+			fftInput = allocate(maxChannels * fftSize);
+			accumulator = allocate(maxChannels * fftSize);
+			fftOutput = allocate(fftSize);
+			work = allocate(fftSize);
+			ready = allocate(maxChannels * blockSize);
+			pending = allocate(maxChannels * blockSize);
+			reset();
+		}
+
+		~Level() {
+			job.setEnabled(false);
+			for (float* buffer : {inputSpectra, window, fftInput, accumulator, fftOutput, work, ready, pending}) {
+				pffft_aligned_free(buffer);
+			}
+		}
+
+		void reset() {
+			if (jobOffloaded) {
+				collectJob();
+			}
+			std::fill(inputSpectra, &inputSpectra[numPartitions * maxChannels * fftSize], 0.f);
+			for (float* buffer : {window, fftInput, accumulator}) {
+				std::fill(buffer, &buffer[maxChannels * fftSize], 0.f);
+			}
+			std::fill(ready, &ready[maxChannels * blockSize], 0.f);
+			std::fill(pending, &pending[maxChannels * blockSize], 0.f);
+			pos = 0;
+			spectrumPos = 0;
+			// nothing pending until the first block is complete
+			task = numTasks;
+		}
+
+		/** Clears the state of channels [oldChannels, newChannels), if any, and sets the number of channels */
+		void setChannels(int oldChannels, int newChannels) {
+			// the worker reads the number of channels
+			if (jobOffloaded) {
+				collectJob();
+			}
+			for (int c = oldChannels; c < newChannels; c++) {
+				for (int slot = 0; slot < numPartitions; slot++) {
+					float* spectrum = &inputSpectra[(slot * maxChannels + c) * fftSize];
+					std::fill(spectrum, &spectrum[fftSize], 0.f);
+				}
+				for (float* buffer : {window, fftInput, accumulator}) {
+					std::fill(&buffer[c * fftSize], &buffer[(c + 1) * fftSize], 0.f);
+				}
+				for (float* buffer : {ready, pending}) {
+					std::fill(&buffer[c * blockSize], &buffer[(c + 1) * blockSize], 0.f);
+				}
+			}
+			channels = newChannels;
+		}
+
+		inline void process(const float* in, float* out, bool offload) {
+			// this level covers taps from 2B onwards, so the block played now is from input two blocks ago
+			for (int c = 0; c < channels; c++) {
+				out[c] += ready[c * blockSize + pos];
+				window[c * fftSize + blockSize + pos] = in[c];
+			}
+
+			if (!jobOffloaded) {
+				// spread the pending job's tasks evenly over the block (from sample `phase`), all done by its last sample
+				const int target = (pos + 1 == blockSize) ? numTasks : ((pos + 1 - phase) * numTasks + blockSize - 1) / blockSize;
+				while (task < target) {
+					runTask(task++);
+				}
+			}
+
+			if (++pos == blockSize) {
+				pos = 0;
+				if (jobOffloaded) {
+					collectJob();
+				}
+				std::swap(ready, pending);
+				// start the job for the block just completed
+				for (int c = 0; c < channels; c++) {
+					std::copy_n(&window[c * fftSize], fftSize, &fftInput[c * fftSize]);
+					std::copy_n(&window[c * fftSize + blockSize], blockSize, &window[c * fftSize]);
+				}
+				task = 0;
+
+				if (offload && offloadable) {
+					jobOffloaded = true;
+					task = numTasks;
+					job.post();
+				}
+			}
+		}
+
+		/** Called by the audio thread at an offloaded job's deadline (runs it, if no worker got to it in time) */
+		void collectJob() {
+			job.wait();
+			jobOffloaded = false;
+		}
+
+		void runJob() {
+			for (int t = 0; t < numTasks; t++) {
+				runTask(t);
+			}
+		}
+
+		void runTask(int t) {
+			if (t == 0) {
+				spectrumPos = (spectrumPos + 1 == numPartitions) ? 0 : spectrumPos + 1;
+				for (int c = 0; c < channels; c++) {
+					pffft_transform(setup, &fftInput[c * fftSize], &inputSpectra[(spectrumPos * maxChannels + c) * fftSize], work, PFFFT_FORWARD);
+				}
+				std::fill(accumulator, &accumulator[channels * fftSize], 0.f);
+			}
+			else if (t <= numPartitions) {
+				// partition p is applied to the input spectrum from p blocks ago, the partition's spectrum stays
+				// in cache from one channel to the next
+				const int p = t - 1;
+				const int slot = (spectrumPos >= p) ? spectrumPos - p : spectrumPos - p + numPartitions;
+				const float* kernelSpectrum = &kernelSpectra[p * fftSize];
+				for (int c = 0; c < channels; c++) {
+					pffft_zconvolve_accumulate(setup, &inputSpectra[(slot * maxChannels + c) * fftSize], kernelSpectrum, &accumulator[c * fftSize],
+					                           1.f / fftSize);
+				}
+			}
+			else {
+				// overlap-save: only the second half of the circular convolution is valid
+				for (int c = 0; c < channels; c++) {
+					pffft_transform(setup, &accumulator[c * fftSize], fftOutput, work, PFFFT_BACKWARD);
+					std::copy_n(&fftOutput[blockSize], blockSize, &pending[c * blockSize]);
+				}
+			}
+		}
+	};
+
+	/** Everything sized by the kernel and the max channels, built off the audio thread and swapped in whole */
+	struct State {
+		const std::shared_ptr<const Kernel> kernel;
+		const int maxChannels;
+		float* headHistory; 	// [channel][2 * headLength]
+		int headPos = 0;
+		std::vector<Level*> levels;
+
+		State(std::shared_ptr<const Kernel> kernel, int maxChannels) : kernel(kernel), maxChannels(maxChannels) {
+			headHistory = allocate(maxChannels * 2 * kernel->headLength);
+			for (const Kernel::LevelKernel& levelKernel : kernel->levels) {
+				levels.push_back(new Level(levelKernel, levels.size(), maxChannels, 1));
+				levels.back()->offloadable = levelKernel.blockSize >= WORKER_MIN_BLOCK_SIZE;
+			}
+		}
+
+		~State() {
+			for (Level* level : levels) {
+				delete level;
+			}
+			pffft_aligned_free(headHistory);
+		}
+
+		void enableJobs(bool enabled) {
+			for (Level* level : levels) {
+				if (level->offloadable) {
+					level->job.setEnabled(enabled);
+				}
+			}
+		}
+	};
+
+	// configuration, only changed off the audio thread, with every such call (and so every start or stop of
+	// a job on the workers) serialised by controlMutex
+	std::mutex controlMutex;
+	std::shared_ptr<const Kernel> kernel;
+	int maxChannels = 1;
+	std::atomic<bool> backgroundThread{false};
+	std::vector<State*> states; 	// every state built and not yet freed, oldest first
+
+	// hand-off: the newest state, until process() takes it, and the state process() is using. process()
+	// only ever moves on to newer states, so those before its current one can be freed
+	std::atomic<State*> nextState{nullptr};
+	std::atomic<State*> activeState{nullptr};
+
+	// audio thread
+	State* state = nullptr;
+	int channels = 1;
+	int requestedChannels = 1; 	// as set, which a new state may not have room for
+
+	/** Builds state for the current configuration, for process() to swap in (controlMutex held) */
+	void buildState() {
+		freeUnusedStates();
+		if (!kernel) {
+			return;
+		}
+		State* built = new State(kernel, maxChannels);
+		if (backgroundThread) {
+			built->enableJobs(true);
+		}
+		states.push_back(built);
+
+		State* replaced = nextState.exchange(built);
+		if (replaced) {
+			// process() never took it
+			states.erase(std::find(states.begin(), states.end(), replaced));
+			delete replaced;
+		}
+	}
+
+	/** Frees the states process() has moved on from (controlMutex held) */
+	void freeUnusedStates() {
+		auto active = std::find(states.begin(), states.end(), activeState.load());
+		if (active == states.end()) {
+			return;
+		}
+		for (auto it = states.begin(); it != active; ++it) {
+			delete *it;
+		}
+		states.erase(states.begin(), active);
+	}
+
+	/** Audio thread: takes the newest state, which was allocated zeroed, so only needs the number of channels */
+	void swapState() {
+		State* newState = nextState.exchange(nullptr);
+		if (!newState) {
+			return;
+		}
+		state = newState;
+		channels = clamp(requestedChannels, 1, state->maxChannels);
+		for (Level* level : state->levels) {
+			level->channels = channels;
+		}
+		activeState = state;
+	}
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <rack.hpp>
+
+// Polynomial band-limited steps and ramps (polyBLEP / polyBLAMP), the two sample polynomial residuals of "Perceptually
+// informed synthesis of bandlimited classical waveforms using integrated polynomial interpolation" (Välimäki et al.) and
+// "Rounding Corners with BLAMP" (Esqueda et al.). Naive waveforms run at the base sample rate have the residual added
+// around each discontinuity (steps) or discontinuity of slope (corners), on the samples either side of it.
+//
+// Phases are in [0, 1] with the discontinuity at phase 0, and deltaPhase (per sample) must be at most 0.5.
+namespace polyblep {
+
+// the residual for a step up of 1 at phase 0
+template <typename T>
+T blep(T phase, T deltaPhase) {
+	const T after = phase / deltaPhase; 				// in [0, 1) just after the step
+	const T before = (phase - 1.0) / deltaPhase; 		// in (-1, 0] just before it
+	return rack::simd::ifelse(phase < deltaPhase, -0.5 * (1.0 - after) * (1.0 - after),
+	                          rack::simd::ifelse(phase > 1.0 - deltaPhase, 0.5 * (1.0 + before) * (1.0 + before), 0.f));
+}
+
+// the residual for an increase in slope of 1 (per unit phase) at phase 0, i.e. the integral of blep()
+template <typename T>
+T blamp(T phase, T deltaPhase) {
+	const T after = 1.0 - phase / deltaPhase;
+	const T before = 1.0 + (phase - 1.0) / deltaPhase;
+	return deltaPhase * rack::simd::ifelse(phase < deltaPhase, after * after * after / 6.0,
+	                                       rack::simd::ifelse(phase > 1.0 - deltaPhase, before * before * before / 6.0, 0.f));
+}
+
+// phase - offset, wrapped to [0, 1] (for discontinuities at phase `offset`, with offset in [0, 1])
+template <typename T>
+T offsetPhase(T phase, T offset) {
+	const T p = phase - offset;
+	return p + rack::simd::ifelse(p < 0.f, 1.f, 0.f);
+}
+
+// -1 to +1 over the cycle
+template <typename T>
+T saw(T phase, T deltaPhase) {
+	return 2 * phase - 1.0 - 2.0 * blep(phase, deltaPhase);
+}
+
+// -1 at phase 0, +1 at phase 0.5
+template <typename T>
+T tri(T phase, T deltaPhase) {
+	return 1.0 - 2.0 * rack::simd::abs(2 * phase - 1.0) + 8.0 * (blamp(phase, deltaPhase) - blamp(offsetPhase(phase, T(0.5f)), deltaPhase));
+}
+
+// -1 before phase `pw`, +1 after
+template <typename T>
+T pulse(T phase, T deltaPhase, T pw) {
+	return rack::simd::ifelse(phase < pw, -1.f, +1.f) - 2.0 * blep(phase, deltaPhase) + 2.0 * blep(offsetPhase(phase, pw), deltaPhase);
+}
+
+} // namespace polyblep
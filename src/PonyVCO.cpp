@@ -1,5 +1,6 @@
 #include "plugin.hpp"
 #include "ChowDSP.hpp"
+#include "DPW.hpp"
 
 using simd::float_4;
 
@@ -106,6 +107,8 @@ struct PonyVCO : Module {
 	float range[4] = {8.f, 1.f, 1.f / 12.f, 10.f};
 	chowdsp::VariableOversampling<6, float_4> oversampler[4]; 	// uses a 2*6=12th order Butterworth filter
 	int oversamplingIndex = 1; 	// default is 2^oversamplingIndex == x2 oversampling
+	chowdsp::OversamplingChangeFader oversamplingFader; 	// fades outputs while oversampling settings change
+	chowdsp::OversamplingFilterType oversamplingFilter = chowdsp::IIR_FILTER; 	// low latency IIR or linear phase FIR
 
 	dsp::TRCFilter<float_4> blockTZFMDCFilter[4];
 	bool blockTZFMDC = true;
@@ -147,9 +150,11 @@ struct PonyVCO : Module {
 
 	void onSampleRateChange() override {
 		float sampleRate = APP->engine->getSampleRate();
+		oversamplingFader.reset(sampleRate);
 		for (int c = 0; c < 4; c++) {
 			blockTZFMDCFilter[c].setCutoffFreq(5.0 / sampleRate);
 			oversampler[c].setOversamplingIndex(oversamplingIndex);
+			oversampler[c].setFilterType(oversamplingFilter);
 			oversampler[c].reset(sampleRate);
 
 			stage1[c].reset();
@@ -157,14 +162,33 @@ struct PonyVCO : Module {
 		}
 	}
 
+	// for the context menu: the oversamplers for the new settings are allocated here, on the UI thread, so that
+	// applying them after the fade out doesn't allocate
+	void requestOversamplingChange() {
+		for (int c = 0; c < 4; c++) {
+			oversampler[c].prepare(oversamplingIndex, oversamplingFilter);
+		}
+		oversamplingFader.requestChange();
+	}
+
 	// implementation taken from "Alias-Suppressed Oscillators Based on Differentiated Polynomial Waveforms",
-	// also the notes from Surge Synthesier repo:
-	// https://github.com/surge-synthesizer/surge/blob/09f1ec8e103265bef6fc0d8a0fc188238197bf8c/src/common/dsp/oscillators/ModernOscillator.cpp#L19
+	// see DPW.hpp
 
 	float_4 phase[4] = {}; 	// phase at current (sub)sample
+	// DPW polynomials at the previous two steps (the pulse is the difference of the offset saw and the saw)
+	dpw::History<float_4> sawHistory[4], offsetSawHistory[4], triHistory[4];
+	// the step size and pulse width the histories were taken at
+	float_4 previousDeltaPhase[4] = {};
+	float_4 previousPW[4] = {};
 
 	void process(const ProcessArgs& args) override {
 
+		// apply any pending change of oversampling settings, once the outputs have faded out
+		if (oversamplingFader.process()) {
+			onSampleRateChange();
+		}
+		const float outputGain = 5.f * oversamplingFader.getGain();
+
 		const int rangeIndex = params[RANGE_PARAM].getValue();
 		const bool lfoMode = rangeIndex == 3;
 
@@ -217,6 +241,22 @@ struct PonyVCO : Module {
 				phase[c / 4] = simd::ifelse(syncMask, 0.f, phase[c / 4]);
 			}
 
+			// the DPW histories hold on from the previous sample, except after sync or a change in frequency (or pulse width,
+			// for the offset saw); those of waveforms not computed go stale. The phases are extrapolated at the base rate,
+			// so with TZFM they're extrapolated on every step, as they always were.
+			const float_4 fmActive = deltaFMPhase != 0.f;
+			const bool anyFMActive = simd::movemask(fmActive) != 0;
+			const float_4 restart = syncMask | fmActive | dpw::isRateChanged(deltaBasePhase, previousDeltaPhase[c / 4]);
+			const float_4 restartOffsetSaw = restart | (pw != previousPW[c / 4]);
+			previousDeltaPhase[c / 4] = deltaBasePhase;
+			previousPW[c / 4] = pw;
+			triHistory[c / 4].stale |= waveform != WAVE_TRI;
+			sawHistory[c / 4].stale |= waveform != WAVE_SAW && waveform != WAVE_PULSE;
+			offsetSawHistory[c / 4].stale |= waveform != WAVE_PULSE;
+			const auto offsetSaw = [pw](float_4 x) {
+				return dpw::offsetSaw(x, pw);
+			};
+
 			float_4* osBuffer = oversampler[c / 4].getOSBuffer();
 			for (int i = 0; i < oversamplingRatio; ++i) {
 
@@ -229,33 +269,39 @@ struct PonyVCO : Module {
 					osBuffer[i] = sin2pi_pade_05_5_4(phase[c / 4]);
 				}
 				else {
-					float_4 phases[3]; // phase as extrapolated to the current and two previous samples
-
-					phases[0] = phase[c / 4] - 2 * deltaBasePhase + simd::ifelse(phase[c / 4] < 2 * deltaBasePhase, 1.f, 0.f);
-					phases[1] = phase[c / 4] - deltaBasePhase + simd::ifelse(phase[c / 4] < deltaBasePhase, 1.f, 0.f);
-					phases[2] = phase[c / 4];
+					const bool extrapolate = (i == 0) || anyFMActive;
 
 					switch (waveform) {
 						case WAVE_TRI: {
+							if (extrapolate) {
+								triHistory[c / 4].extrapolate(i == 0 ? restart : fmActive, phase[c / 4], deltaBasePhase, dpw::tri<float_4>);
+							}
 							const float_4 dpwOrder1 = 1.0 - 2.0 * simd::abs(2 * phase[c / 4] - 1.0);
-							const float_4 dpwOrder3 = aliasSuppressedTri(phases) * denominatorInv;
+							const float_4 dpwOrder3 = triHistory[c / 4].process(dpw::tri(phase[c / 4])) * denominatorInv;
 
 							osBuffer[i] = simd::ifelse(lowFreqRegime, dpwOrder1, dpwOrder3);
 							break;
 						}
 						case WAVE_SAW: {
+							if (extrapolate) {
+								sawHistory[c / 4].extrapolate(i == 0 ? restart : fmActive, phase[c / 4], deltaBasePhase, dpw::saw<float_4>);
+							}
 							const float_4 dpwOrder1 = 2 * phase[c / 4] - 1.0;
-							const float_4 dpwOrder3 = aliasSuppressedSaw(phases) * denominatorInv;
+							const float_4 dpwOrder3 = sawHistory[c / 4].process(dpw::saw(phase[c / 4])) * denominatorInv;
 
 							osBuffer[i] = simd::ifelse(lowFreqRegime, dpwOrder1, dpwOrder3);
 							break;
 						}
 						case WAVE_PULSE: {
+							if (extrapolate) {
+								sawHistory[c / 4].extrapolate(i == 0 ? restart : fmActive, phase[c / 4], deltaBasePhase, dpw::saw<float_4>);
+								offsetSawHistory[c / 4].extrapolate(i == 0 ? restartOffsetSaw : fmActive, phase[c / 4], deltaBasePhase, offsetSaw);
+							}
 							float_4 dpwOrder1 = simd::ifelse(phase[c / 4] < 1. - pw, +1.0, -1.0);
 							dpwOrder1 -= removePulseDC ? 2.f * (0.5f - pw) : 0.f;
 
-							float_4 saw = aliasSuppressedSaw(phases);
-							float_4 sawOffset = aliasSuppressedOffsetSaw(phases, pw);
+							float_4 saw = sawHistory[c / 4].process(dpw::saw(phase[c / 4]));
+							float_4 sawOffset = offsetSawHistory[c / 4].process(offsetSaw(phase[c / 4]));
 							float_4 dpwOrder3 = (sawOffset - saw) * denominatorInv + pulseDCOffset;
 
 							osBuffer[i] = simd::ifelse(lowFreqRegime, dpwOrder1, dpwOrder3);
@@ -276,45 +322,13 @@ struct PonyVCO : Module {
 
 			// end of chain VCA
 			const float_4 gain = simd::clamp(inputs[VCA_INPUT].getNormalPolyVoltageSimd<float_4>(10.f, c) / 10.f, 0.f, 1.f);
-			outputs[OUT_OUTPUT].setVoltageSimd(5.f * out * gain, c);
+			outputs[OUT_OUTPUT].setVoltageSimd(outputGain * out * gain, c);
 
 		} 	// end of channels loop
 
 		outputs[OUT_OUTPUT].setChannels(channels);
 	}
 
-	float_4 aliasSuppressedTri(float_4* phases) {
-		float_4 triBuffer[3];
-		for (int i = 0; i < 3; ++i) {
-			float_4 p = 2 * phases[i] - 1.0; 				// range -1.0 to +1.0
-			float_4 s = 0.5 - simd::abs(p); 				// eq 30
-			triBuffer[i] = (s * s * s - 0.75 * s) / 3.0; 	// eq 29
-		}
-		return (triBuffer[0] - 2.0 * triBuffer[1] + triBuffer[2]);
-	}
-
-	float_4 aliasSuppressedSaw(float_4* phases) {
-		float_4 sawBuffer[3];
-		for (int i = 0; i < 3; ++i) {
-			float_4 p = 2 * phases[i] - 1.0; 		// range -1 to +1
-			sawBuffer[i] = (p * p * p - p) / 6.0;	// eq 11
-		}
-
-		return (sawBuffer[0] - 2.0 * sawBuffer[1] + sawBuffer[2]);
-	}
-
-	float_4 aliasSuppressedOffsetSaw(float_4* phases, float_4 pw) {
-		float_4 sawOffsetBuff[3];
-
-		for (int i = 0; i < 3; ++i) {
-			float_4 p = 2 * phases[i] - 1.0; 		// range -1 to +1
-			float_4 pwp = p + 2 * pw;				// phase after pw (pw in [0, 1])
-			pwp += simd::ifelse(pwp > 1, -2, 0);     			// modulo on [-1, +1]
-			sawOffsetBuff[i] = (pwp * pwp * pwp - pwp) / 6.0;	// eq 11
-		}
-		return (sawOffsetBuff[0] - 2.0 * sawOffsetBuff[1] + sawOffsetBuff[2]);
-	}
-
 	float_4 wavefolder(float_4 x, float_4 xt, int c) {
 		return stage2[c / 4].process(stage1[c / 4].process(x, xt));
 	}
@@ -325,6 +339,7 @@ struct PonyVCO : Module {
 		json_object_set_new(rootJ, "removePulseDC", json_boolean(removePulseDC));
 		json_object_set_new(rootJ, "limitPW", json_boolean(limitPW));
 		json_object_set_new(rootJ, "oversamplingIndex", json_integer(oversampler[0].getOversamplingIndex()));
+		json_object_set_new(rootJ, "oversamplingFilter", json_integer(oversamplingFilter));
 		return rootJ;
 	}
 
@@ -345,6 +360,12 @@ struct PonyVCO : Module {
 			limitPW = json_boolean_value(limitPWJ);
 		}
 
+		json_t* oversamplingFilterJ = json_object_get(rootJ, "oversamplingFilter");
+		if (oversamplingFilterJ) {
+			oversamplingFilter = (chowdsp::OversamplingFilterType) json_integer_value(oversamplingFilterJ);
+			onSampleRateChange();
+		}
+
 		json_t* oversamplingIndexJ = json_object_get(rootJ, "oversamplingIndex");
 		if (oversamplingIndexJ) {
 			oversamplingIndex = json_integer_value(oversamplingIndexJ);
@@ -397,7 +418,18 @@ struct PonyVCOWidget : ModuleWidget {
 		},
 		[ = ](int mode) {
 			module->oversamplingIndex = mode;
-			module->onSampleRateChange();
+			module->requestOversamplingChange();
+		}
+		                                     ));
+
+		menu->addChild(createIndexSubmenuItem("Oversampling filter",
+		{"Low latency (IIR)", "High quality (FIR)"},
+		[ = ]() {
+			return module->oversamplingFilter;
+		},
+		[ = ](int mode) {
+			module->oversamplingFilter = (chowdsp::OversamplingFilterType) mode;
+			module->requestOversamplingChange();
 		}
 		                                     ));
 
@@ -0,0 +1,125 @@
+#include "RenderWorkers.hpp"
+
+#include <rack.hpp>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** The threads running posted jobs for all instances, which run while any job is enabled */
+struct RenderWorkers {
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::vector<RenderJob*> jobs;
+	std::vector<std::thread> threads;
+	bool quit = false;
+
+	static RenderWorkers& get() {
+		static RenderWorkers workers;
+		return workers;
+	}
+
+	void add(RenderJob* job) {
+		std::lock_guard<std::mutex> lock(mutex);
+		jobs.push_back(job);
+		if (threads.empty()) {
+			quit = false;
+			// jobs may use the engine (e.g. sample rate)
+			rack::Context* context = rack::contextGet();
+			for (int i = 0; i < RenderJob::numWorkers; i++) {
+				threads.emplace_back([this, context]() {
+					rack::contextSet(context);
+					run();
+				});
+			}
+		}
+	}
+
+	void remove(RenderJob* job) {
+		std::vector<std::thread> stopped;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			jobs.erase(std::remove(jobs.begin(), jobs.end(), job), jobs.end());
+			if (jobs.empty()) {
+				quit = true;
+				stopped = std::move(threads);
+				threads.clear();
+			}
+		}
+		wake.notify_all();
+		for (std::thread& thread : stopped) {
+			thread.join();
+		}
+		// a worker may have taken the job just before it was removed
+		while (job->state.load() == RenderJob::RUNNING) {
+			std::this_thread::yield();
+		}
+	}
+
+	void run() {
+		std::unique_lock<std::mutex> lock(mutex);
+		while (!quit) {
+			// jobs are claimed with the lock held, so none can be removed meanwhile, but run without it
+			RenderJob* claimed = nullptr;
+			for (RenderJob* job : jobs) {
+				if (job->claim()) {
+					claimed = job;
+					break;
+				}
+			}
+			if (claimed) {
+				lock.unlock();
+				claimed->runClaimed();
+				lock.lock();
+				continue;
+			}
+			// no timeout: the audio thread doesn't take the lock to notify, so a wakeup can (rarely) be missed, but
+			// then wait() runs that job at its deadline, and the next post() wakes a worker again
+			wake.wait(lock);
+		}
+	}
+};
+
+RenderJob::~RenderJob() {
+	setEnabled(false);
+}
+
+void RenderJob::setEnabled(bool enabled) {
+	if (enabled == this->enabled) {
+		return;
+	}
+	this->enabled = enabled;
+	if (enabled) {
+		RenderWorkers::get().add(this);
+	}
+	else {
+		RenderWorkers::get().remove(this);
+	}
+}
+
+void RenderJob::post() {
+	state = QUEUED;
+	RenderWorkers::get().wake.notify_one();
+}
+
+void RenderJob::wait() {
+	if (claim()) {
+		// no worker has got to it (or they aren't running)
+		runClaimed();
+		return;
+	}
+	while (state.load() != IDLE) {
+		std::this_thread::yield();
+	}
+}
+
+bool RenderJob::claim() {
+	int expected = QUEUED;
+	return state.compare_exchange_strong(expected, RUNNING);
+}
+
+void RenderJob::runClaimed() {
+	run();
+	state = IDLE;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+
+/**
+ * Work posted by the audio thread to a few worker threads shared by all instances (of all modules), e.g.
+ * rendering the next blocks of NoisePlethora's algorithms while the audio thread plays the current ones, or
+ * the tail partitions of a PartitionedConvolver.
+ *
+ * The audio thread must wait() for a posted job before touching anything the job uses. If no worker has started
+ * the job by then, wait() runs it there and then, so a job always completes, however busy the workers are (or
+ * whether they're running at all).
+ *
+ * Workers only run while a job is enabled, so there are no extra threads unless an instance asks for them, and
+ * sleep until a job is posted.
+ */
+class RenderJob {
+public:
+	// workers shared by all jobs
+	static constexpr int numWorkers = 2;
+
+	RenderJob() {}
+	// subclasses must be disabled (setEnabled(false)) before they're destroyed, as a worker may be running them
+	virtual ~RenderJob();
+
+	RenderJob(const RenderJob&) = delete;
+	RenderJob& operator=(const RenderJob&) = delete;
+
+	/** Not for the audio thread: whether the workers take this job, else it's only run by wait() */
+	void setEnabled(bool enabled);
+
+	/** Audio thread only: queues the job, which mustn't be pending */
+	void post();
+
+	/** Audio thread (or while it's stopped): returns once a posted job has been run */
+	void wait();
+
+	bool isPending() const {
+		return state.load() != IDLE;
+	}
+
+protected:
+	virtual void run() = 0;
+
+private:
+	friend struct RenderWorkers;
+
+	enum State {
+		IDLE,
+		QUEUED,
+		RUNNING
+	};
+	std::atomic<int> state{IDLE};
+	bool enabled = false;
+
+	// whoever moves the job from QUEUED to RUNNING runs it
+	bool claim();
+	void runClaimed();
+};
@@ -1,22 +1,100 @@
 #include "plugin.hpp"
-#include <pffft.h>
+#include "PartitionedConvolver.hpp"
+#include "MappedFile.hpp"
+#include <thread>
+
+// sample rate the IR was recorded at, IRs for other sample rates are resampled from it
+static const float IR_SAMPLE_RATE = 48000.f;
+
+static double besselI0(double x) {
+	double sum = 1.0, term = 1.0;
+	for (int k = 1; k < 32; k++) {
+		term *= (x / (2 * k)) * (x / (2 * k));
+		sum += term;
+	}
+	return sum;
+}
 
-static std::vector<uint8_t> ir;
+/**
+ * Band-limited (Kaiser windowed sinc) resampling of an IR recorded at IR_SAMPLE_RATE to `sampleRate`,
+ * scaled so that the reverb's level doesn't depend on the sample rate. Done once per sample rate, so
+ * uses a much longer filter than a real-time sample rate converter would.
+ */
+static std::vector<float> resampleIR(const float* ir, size_t length, float sampleRate) {
+	const double ratio = sampleRate / IR_SAMPLE_RATE;
+	// in cycles per IR sample, with a small transition band below the lower Nyquist frequency
+	const double cutoff = 0.475 * std::min(1.0, ratio);
+	const int zeroCrossings = 32;
+	const double halfWidth = zeroCrossings / (2 * cutoff);
+	const double beta = 10.0;
+
+	// windowed sinc, tabulated over its (IR sample) distance from the output sample, linearly interpolated
+	const int tableResolution = 512;
+	std::vector<float> table(std::ceil(halfWidth * tableResolution) + 2, 0.f);
+	for (size_t i = 0; i < table.size(); i++) {
+		const double d = (double) i / tableResolution;
+		if (d < halfWidth) {
+			const double x = 2 * cutoff * d;
+			const double sinc = (x == 0.0) ? 1.0 : std::sin(M_PI * x) / (M_PI * x);
+			const double window = besselI0(beta * std::sqrt(1.0 - (d / halfWidth) * (d / halfWidth))) / besselI0(beta);
+			table[i] = 2 * cutoff * sinc * window;
+		}
+	}
+
+	std::vector<float> resampled((size_t) std::ceil(length * ratio));
+	for (size_t n = 0; n < resampled.size(); n++) {
+		const double t = n / ratio;
+		const int64_t first = std::max<int64_t>(0, std::ceil(t - halfWidth));
+		const int64_t last = std::min<int64_t>(length - 1, std::floor(t + halfWidth));
+		double sum = 0.0;
+		for (int64_t k = first; k <= last; k++) {
+			const double index = std::abs(t - k) * tableResolution;
+			const size_t i = index;
+			const float frac = index - i;
+			sum += ir[k] * (table[i] + frac * (table[i + 1] - table[i]));
+		}
+		resampled[n] = sum / ratio;
+	}
+	return resampled;
+}
 
-static void initIR() {
-	if (!ir.empty())
-		return;
+/**
+ * Kernels are built (resampled, partitioned and transformed) once per sample rate, and shared by all
+ * instances running at that rate, then freed with the last of those instances. Returns an empty kernel if
+ * the IR can't be loaded.
+ */
+static std::shared_ptr<const PartitionedConvolver::Kernel> getKernel(const std::string& path, float sampleRate) {
+	static std::mutex cacheMutex;
+	static std::map<std::pair<std::string, float>, std::weak_ptr<const PartitionedConvolver::Kernel>> cache;
+
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	const std::pair<std::string, float> key(path, sampleRate);
+	std::shared_ptr<const PartitionedConvolver::Kernel> kernel = cache[key].lock();
+	if (kernel) {
+		return kernel;
+	}
 
 	try {
-		ir = system::readFile(asset::plugin(pluginInstance, "res/SpringReverbIR.f32"));
+		// only needed while the kernel is built
+		MappedFile file(path);
+		const float* ir = (const float*) file.data();
+		const size_t length = file.size() / sizeof(float);
+		if (sampleRate == IR_SAMPLE_RATE) {
+			kernel = std::make_shared<const PartitionedConvolver::Kernel>(ir, length);
+		}
+		else {
+			const std::vector<float> resampled = resampleIR(ir, length, sampleRate);
+			kernel = std::make_shared<const PartitionedConvolver::Kernel>(resampled.data(), resampled.size());
+		}
+		cache[key] = kernel;
 	}
 	catch (std::exception& e) {
 		WARN("Cannot load IR: %s", e.what());
+		kernel = std::make_shared<const PartitionedConvolver::Kernel>(nullptr, 0);
 	}
+	return kernel;
 }
 
-static const size_t BLOCK_SIZE = 1024;
-
 
 struct SpringReverb : Module {
 	enum ParamIds {
@@ -45,13 +123,23 @@ struct SpringReverb : Module {
 		NUM_LIGHTS
 	};
 
-	dsp::RealTimeConvolver* convolver = NULL;
-	dsp::SampleRateConverter<1> inputSrc;
-	dsp::SampleRateConverter<1> outputSrc;
-	dsp::DoubleRingBuffer<dsp::Frame<1>, 16 * BLOCK_SIZE> inputBuffer;
-	dsp::DoubleRingBuffer<dsp::Frame<1>, 16 * BLOCK_SIZE> outputBuffer;
+	enum ChannelMode {
+		MONO_CHANNELS, 		// inputs (and all their channels) summed, as the hardware
+		STEREO_CHANNELS, 	// In 1 (left) and In 2 (right) reverberated separately
+		POLY_CHANNELS, 		// each channel (of In 1 plus In 2) reverberated separately
+		NUM_CHANNEL_MODES
+	};
+	ChannelMode channelMode = MONO_CHANNELS;
+
+	PartitionedConvolver convolver; 	// zero latency, with CPU load spread evenly over samples, at the engine's sample rate
+	// kernels for a new sample rate are built on a loader thread, as onSampleRateChange() is called with the engine
+	// locked, and the convolver swaps them in once they're ready
+	std::thread kernelLoader;
+	float kernelSampleRate = 0.f;
+	// the long tail of the convolution is computed on a worker thread, rather than the engine's
+	bool backgroundThread = false;
 
-	dsp::RCFilter dryFilter;
+	dsp::RCFilter dryFilters[PORT_MAX_CHANNELS];
 
 	dsp::VuMeter2 vuFilter;
 	dsp::VuMeter2 lightFilter;
@@ -66,13 +154,9 @@ struct SpringReverb : Module {
 		configParam(LEVEL2_PARAM, 0.0, 1.0, 0.0, "In 2 level", "%", 0, 100);
 		configParam(HPF_PARAM, 0.0, 1.0, 0.5, "High pass filter cutoff");
 
-		initIR();
-
-		convolver = new dsp::RealTimeConvolver(BLOCK_SIZE);
-
-		const float* kernel = (const float*) ir.data();
-		size_t kernelLen = ir.size() / sizeof(float);
-		convolver->setKernel(kernel, kernelLen);
+		// nothing is processing yet, so the first kernel is built here
+		kernelSampleRate = APP->engine->getSampleRate();
+		convolver.setKernel(getKernel(asset::plugin(pluginInstance, "res/SpringReverbIR.f32"), kernelSampleRate));
 
 		vuFilter.mode = dsp::VuMeter2::PEAK;
 		lightFilter.mode = dsp::VuMeter2::PEAK;
@@ -81,81 +165,150 @@ struct SpringReverb : Module {
 	}
 
 	~SpringReverb() {
-		delete convolver;
+		if (kernelLoader.joinable()) {
+			kernelLoader.join();
+		}
+	}
+
+	void onSampleRateChange() override {
+		const float sampleRate = APP->engine->getSampleRate();
+		if (sampleRate == kernelSampleRate) {
+			return;
+		}
+		kernelSampleRate = sampleRate;
+
+		// one load at a time, so the latest rate's kernel is set last (a previous load is rarely still running)
+		if (kernelLoader.joinable()) {
+			kernelLoader.join();
+		}
+		const std::string path = asset::plugin(pluginInstance, "res/SpringReverbIR.f32");
+		kernelLoader = std::thread([this, path, sampleRate]() {
+			convolver.setKernel(getKernel(path, sampleRate));
+		});
+	}
+
+	/** Not for the audio thread: the convolver's state for the mode is built here, and swapped in by process() */
+	void setChannelMode(ChannelMode mode) {
+		channelMode = mode;
+		convolver.setMaxChannels(mode == POLY_CHANNELS ? PORT_MAX_CHANNELS : (mode == STEREO_CHANNELS) ? 2 : 1);
+	}
+
+	void setBackgroundThread(bool enabled) {
+		backgroundThread = enabled;
+		convolver.setBackgroundThread(enabled);
+	}
+
+	json_t* dataToJson() override {
+		json_t* rootJ = json_object();
+		json_object_set_new(rootJ, "backgroundThread", json_boolean(backgroundThread));
+		json_object_set_new(rootJ, "channelMode", json_integer(channelMode));
+		return rootJ;
+	}
+
+	void dataFromJson(json_t* rootJ) override {
+		json_t* backgroundThreadJ = json_object_get(rootJ, "backgroundThread");
+		if (backgroundThreadJ) {
+			setBackgroundThread(json_boolean_value(backgroundThreadJ));
+		}
+
+		json_t* channelModeJ = json_object_get(rootJ, "channelMode");
+		if (channelModeJ) {
+			setChannelMode((ChannelMode) clamp((int) json_integer_value(channelModeJ), 0, NUM_CHANNEL_MODES - 1));
+		}
+	}
+
+	int getChannels() {
+		switch (channelMode) {
+			case STEREO_CHANNELS: return 2;
+			case POLY_CHANNELS: return std::max({1, inputs[IN1_INPUT].getChannels(), inputs[IN2_INPUT].getChannels()});
+			default: return 1;
+		}
+	}
+
+	/** The voltages from In 1 and In 2 that feed channel c */
+	void getInputs(int c, float& in1, float& in2) {
+		switch (channelMode) {
+			case STEREO_CHANNELS: {
+				in1 = (c == 0) ? inputs[IN1_INPUT].getVoltageSum() : 0.f;
+				in2 = (c == 1) ? inputs[IN2_INPUT].getVoltageSum() : 0.f;
+				break;
+			}
+			case POLY_CHANNELS: {
+				in1 = inputs[IN1_INPUT].getVoltage(c);
+				in2 = inputs[IN2_INPUT].getVoltage(c);
+				break;
+			}
+			default: {
+				in1 = inputs[IN1_INPUT].getVoltageSum();
+				in2 = inputs[IN2_INPUT].getVoltageSum();
+				break;
+			}
+		}
 	}
 
 	void processBypass(const ProcessArgs& args) override {
-		float in1 = inputs[IN1_INPUT].getVoltageSum();
-		float in2 = inputs[IN2_INPUT].getVoltageSum();
+		const int channels = getChannels();
+		for (int c = 0; c < channels; c++) {
+			float in1, in2;
+			getInputs(c, in1, in2);
 
-		float dry = clamp(in1 + in2, -10.0f, 10.0f);
+			float dry = clamp(in1 + in2, -10.0f, 10.0f);
 
-		outputs[WET_OUTPUT].setVoltage(dry);
-		outputs[MIX_OUTPUT].setVoltage(dry);
+			outputs[WET_OUTPUT].setVoltage(dry, c);
+			outputs[MIX_OUTPUT].setVoltage(dry, c);
+		}
+		outputs[WET_OUTPUT].setChannels(channels);
+		outputs[MIX_OUTPUT].setChannels(channels);
 	}
 
 	void process(const ProcessArgs& args) override {
-		float in1 = inputs[IN1_INPUT].getVoltageSum();
-		float in2 = inputs[IN2_INPUT].getVoltageSum();
+		const int channels = getChannels();
+		convolver.setChannels(channels);
+
 		const float levelScale = 0.030;
 		const float levelBase = 25.0;
 		float level1 = levelScale * dsp::exponentialBipolar(levelBase, params[LEVEL1_PARAM].getValue()) * inputs[CV1_INPUT].getNormalVoltage(10.0) / 10.0;
 		float level2 = levelScale * dsp::exponentialBipolar(levelBase, params[LEVEL2_PARAM].getValue()) * inputs[CV2_INPUT].getNormalVoltage(10.0) / 10.0;
-		float dry = in1 * level1 + in2 * level2;
-
-		// HPF on dry
 		float dryCutoff = 200.0 * std::pow(20.0, params[HPF_PARAM].getValue()) * args.sampleTime;
-		dryFilter.setCutoff(dryCutoff);
-		dryFilter.process(dry);
-
-		// Add dry to input buffer
-		if (!inputBuffer.full()) {
-			dsp::Frame<1> inputFrame;
-			inputFrame.samples[0] = dryFilter.highpass();
-			inputBuffer.push(inputFrame);
-		}
-
-
-		if (outputBuffer.empty()) {
-			float input[BLOCK_SIZE] = {};
-			float output[BLOCK_SIZE];
-			// Convert input buffer
-			{
-				inputSrc.setRates(args.sampleRate, 48000);
-				int inLen = inputBuffer.size();
-				int outLen = BLOCK_SIZE;
-				inputSrc.process(inputBuffer.startData(), &inLen, (dsp::Frame<1>*) input, &outLen);
-				inputBuffer.startIncr(inLen);
-			}
-
-			// Convolve block
-			convolver->processBlock(input, output);
 
-			// Convert output buffer
-			{
-				outputSrc.setRates(48000, args.sampleRate);
-				int inLen = BLOCK_SIZE;
-				int outLen = outputBuffer.capacity();
-				outputSrc.process((dsp::Frame<1>*) output, &inLen, outputBuffer.endData(), &outLen);
-				outputBuffer.endIncr(outLen);
-			}
+		float through[PORT_MAX_CHANNELS];
+		float dryFiltered[PORT_MAX_CHANNELS];
+		// channels the convolver doesn't have yet (until it swaps in the state for a new mode) are silent
+		float wet[PORT_MAX_CHANNELS] = {};
+		float dryPeak = 0.f;
+		for (int c = 0; c < channels; c++) {
+			float in1, in2;
+			getInputs(c, in1, in2);
+			float dry = in1 * level1 + in2 * level2;
+			dryPeak = std::max(dryPeak, std::abs(dry));
+			// the mix is of In 1 with the reverb, or in stereo, of each side with its reverb
+			through[c] = (channelMode == STEREO_CHANNELS) ? in1 + in2 : in1;
+
+			// HPF on dry
+			dryFilters[c].setCutoff(dryCutoff);
+			dryFilters[c].process(dry);
+			dryFiltered[c] = dryFilters[c].highpass();
 		}
 
-		// Set output
-		if (outputBuffer.empty())
-			return;
+		// all channels against the same kernel
+		convolver.process(dryFiltered, wet);
 
-		float wet = outputBuffer.shift().samples[0];
-		float balance = clamp(params[WET_PARAM].getValue() + inputs[MIX_CV_INPUT].getVoltage() / 10.0f, 0.0f, 1.0f);
-		float mix = crossfade(in1, wet, balance);
+		float wetPeak = 0.f;
+		for (int c = 0; c < channels; c++) {
+			float balance = clamp(params[WET_PARAM].getValue() + inputs[MIX_CV_INPUT].getPolyVoltage(c) / 10.0f, 0.0f, 1.0f);
+			float mix = crossfade(through[c], wet[c], balance);
 
-		outputs[WET_OUTPUT].setVoltage(clamp(wet, -10.0f, 10.0f));
-		outputs[MIX_OUTPUT].setVoltage(clamp(mix, -10.0f, 10.0f));
+			outputs[WET_OUTPUT].setVoltage(clamp(wet[c], -10.0f, 10.0f), c);
+			outputs[MIX_OUTPUT].setVoltage(clamp(mix, -10.0f, 10.0f), c);
+			wetPeak = std::max(wetPeak, std::abs(wet[c]));
+		}
+		outputs[WET_OUTPUT].setChannels(channels);
+		outputs[MIX_OUTPUT].setChannels(channels);
 
-		// process VU lights
-		vuFilter.process(args.sampleTime, wet);
+		// process VU lights (loudest channel)
+		vuFilter.process(args.sampleTime, wetPeak);
 		// process peak light
-		lightFilter.process(args.sampleTime, dry * 50.0);
+		lightFilter.process(args.sampleTime, dryPeak * 50.0);
 
 		if (lightRefreshClock.process()) {
 
@@ -205,6 +358,37 @@ struct SpringReverbWidget : ModuleWidget {
 		addChild(createLight<MediumLight<GreenLight>>(Vec(55, 175), module, SpringReverb::VU1_LIGHTS + 5));
 		addChild(createLight<MediumLight<GreenLight>>(Vec(55, 188), module, SpringReverb::VU1_LIGHTS + 6));
 	}
+
+	void step() override {
+		SpringReverb* module = dynamic_cast<SpringReverb*>(this->module);
+		if (module) {
+			// frees the state the convolver swapped out on a change of kernel or channel mode
+			module->convolver.freeUnusedState();
+		}
+		ModuleWidget::step();
+	}
+
+	void appendContextMenu(Menu* menu) override {
+		SpringReverb* module = dynamic_cast<SpringReverb*>(this->module);
+		assert(module);
+
+		menu->addChild(new MenuSeparator());
+		menu->addChild(createIndexSubmenuItem("Channels",
+		{"Mono (sum of inputs)", "Stereo (In 1 left, In 2 right)", "Polyphonic"},
+		[ = ]() {
+			return module->channelMode;
+		},
+		[ = ](int mode) {
+			module->setChannelMode((SpringReverb::ChannelMode) mode);
+		}));
+		menu->addChild(createBoolMenuItem("Process reverb tail on background thread", "",
+		[ = ]() {
+			return module->backgroundThread;
+		},
+		[ = ](bool enabled) {
+			module->setBackgroundThread(enabled);
+		}));
+	}
 };
 
 
@@ -0,0 +1,266 @@
+#include "AlgorithmPool.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// created and initialised, ready to play at the engine's current sample rate
+static NoisePlethoraPlugin* createAlgorithm(int program, uint64_t seed, float* sampleRate) {
+	// the program's noise sources are seeded in turn as they're constructed
+	uint64_t state = seed ^ (uint64_t) program;
+	teensy::seedSequence() = teensy::splitMix64(state);
+	NoisePlethoraPlugin* algorithm = createProgram(program);
+	if (!algorithm) {
+		return nullptr;
+	}
+	*sampleRate = APP->engine->getSampleRate();
+	algorithm->init();
+	return algorithm;
+}
+
+/** The thread creating (and deleting) algorithms for all pools, which runs while any pool exists */
+struct AlgorithmLoader {
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::vector<AlgorithmPool*> pools;
+	std::thread thread;
+	bool quit = false;
+
+	static AlgorithmLoader& get() {
+		static AlgorithmLoader loader;
+		return loader;
+	}
+
+	void add(AlgorithmPool* pool) {
+		std::lock_guard<std::mutex> lock(mutex);
+		pools.push_back(pool);
+		if (!thread.joinable()) {
+			quit = false;
+			// algorithms may use the engine (e.g. sample rate)
+			rack::Context* context = rack::contextGet();
+			thread = std::thread([this, context]() {
+				rack::contextSet(context);
+				run();
+			});
+		}
+	}
+
+	void remove(AlgorithmPool* pool) {
+		std::thread stopped;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			pools.erase(std::remove(pools.begin(), pools.end(), pool), pools.end());
+			if (pools.empty()) {
+				quit = true;
+				stopped = std::move(thread);
+			}
+		}
+		if (stopped.joinable()) {
+			wake.notify_one();
+			stopped.join();
+		}
+	}
+
+	void run() {
+		std::unique_lock<std::mutex> lock(mutex);
+		while (!quit) {
+			// pools are serviced with the lock held, so none can be removed meanwhile
+			for (AlgorithmPool* pool : pools) {
+				pool->serviceRequests();
+			}
+			// the audio thread doesn't take the lock to notify, so a wakeup can be missed: poll too
+			wake.wait_for(lock, std::chrono::milliseconds(5));
+		}
+	}
+};
+
+AlgorithmPool::AlgorithmPool() {
+	for (auto& request : requests) {
+		request = -1;
+	}
+	AlgorithmLoader::get().add(this);
+}
+
+AlgorithmPool::~AlgorithmPool() {
+	AlgorithmLoader::get().remove(this);
+
+	for (Entry& entry : entries) {
+		delete entry.algorithm;
+	}
+	for (Delivery& delivery : deliveries) {
+		if (delivery.state == FULL) {
+			delete delivery.algorithm;
+		}
+	}
+	for (auto& algorithm : retired) {
+		delete algorithm.load();
+	}
+}
+
+NoisePlethoraPlugin* AlgorithmPool::acquire(int program) {
+	collectDeliveries();
+
+	for (Entry& entry : entries) {
+		if (entry.algorithm && entry.program == program) {
+			entry.lastUsed = ++clock;
+			if (entry.algorithm != active) {
+				// only initialised here if it's been played before (or the sample rate has changed since)
+				if (entry.readySampleRate != APP->engine->getSampleRate()) {
+					entry.algorithm->init();
+				}
+				entry.readySampleRate = 0.f;
+				previous = active;
+				active = entry.algorithm;
+			}
+			return active;
+		}
+	}
+
+	if (!isRequested(program)) {
+		requests[0] = program;
+		AlgorithmLoader::get().wake.notify_one();
+	}
+	return nullptr;
+}
+
+void AlgorithmPool::prefetch(int program) {
+	collectDeliveries();
+
+	for (Entry& entry : entries) {
+		if (entry.algorithm && entry.program == program) {
+			if (entry.readySampleRate == APP->engine->getSampleRate() || entry.algorithm == active || entry.algorithm == previous) {
+				return;
+			}
+			// played already, so replace it with a fresh one (if it can't be retired just now, try again next time)
+			if (!retire(entry.algorithm)) {
+				return;
+			}
+			entry = Entry();
+			break;
+		}
+	}
+
+	if (isRequested(program)) {
+		return;
+	}
+	for (int i = 1; i < numRequests; i++) {
+		int expected = -1;
+		if (requests[i].compare_exchange_strong(expected, program)) {
+			AlgorithmLoader::get().wake.notify_one();
+			return;
+		}
+	}
+}
+
+void AlgorithmPool::releasePrevious() {
+	previous = nullptr;
+}
+
+void AlgorithmPool::preload(int program) {
+	float sampleRate;
+	NoisePlethoraPlugin* algorithm = createAlgorithm(program, seed, &sampleRate);
+	if (algorithm && !deliver(program, algorithm, sampleRate)) {
+		delete algorithm;
+	}
+}
+
+bool AlgorithmPool::isRequested(int program) const {
+	for (const auto& request : requests) {
+		if (request.load() == program) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void AlgorithmPool::collectDeliveries() {
+	for (Delivery& delivery : deliveries) {
+		if (delivery.state != FULL) {
+			continue;
+		}
+		// a cached copy is replaced (e.g. preloaded after the seed has changed), unless it's playing, in which case
+		// the delivery is discarded
+		Entry* target = nullptr;
+		for (Entry& entry : entries) {
+			if (entry.algorithm && entry.program == delivery.program) {
+				target = &entry;
+			}
+		}
+		if (target && (target->algorithm == active || target->algorithm == previous)) {
+			if (retire(delivery.algorithm)) {
+				delivery.state = EMPTY;
+			}
+			continue;
+		}
+
+		// else a free entry, or else the least recently used, but never the active or previous algorithm
+		if (!target) {
+			for (Entry& entry : entries) {
+				if (!entry.algorithm) {
+					target = &entry;
+					break;
+				}
+				if (entry.algorithm != active && entry.algorithm != previous && (!target || entry.lastUsed < target->lastUsed)) {
+					target = &entry;
+				}
+			}
+		}
+		// if nothing can be retired just now, try again on the next call
+		if (target->algorithm && !retire(target->algorithm)) {
+			continue;
+		}
+		target->program = delivery.program;
+		target->algorithm = delivery.algorithm;
+		target->lastUsed = clock;
+		target->readySampleRate = delivery.sampleRate;
+		delivery.state = EMPTY;
+	}
+}
+
+bool AlgorithmPool::retire(NoisePlethoraPlugin* algorithm) {
+	for (auto& slot : retired) {
+		NoisePlethoraPlugin* expected = nullptr;
+		if (slot.compare_exchange_strong(expected, algorithm)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool AlgorithmPool::deliver(int program, NoisePlethoraPlugin* algorithm, float sampleRate) {
+	for (Delivery& delivery : deliveries) {
+		int expected = EMPTY;
+		if (delivery.state.compare_exchange_strong(expected, CLAIMED)) {
+			delivery.program = program;
+			delivery.algorithm = algorithm;
+			delivery.sampleRate = sampleRate;
+			delivery.state = FULL;
+			return true;
+		}
+	}
+	return false;
+}
+
+void AlgorithmPool::serviceRequests() {
+	for (auto& slot : retired) {
+		delete slot.exchange(nullptr);
+	}
+
+	for (auto& request : requests) {
+		int program = request.load();
+		if (program < 0) {
+			continue;
+		}
+		float sampleRate;
+		NoisePlethoraPlugin* algorithm = createAlgorithm(program, seed, &sampleRate);
+		if (algorithm && !deliver(program, algorithm, sampleRate)) {
+			// the audio thread hasn't collected earlier deliveries yet, retry next time
+			delete algorithm;
+			continue;
+		}
+		// done, unless the audio thread has replaced the request meanwhile
+		request.compare_exchange_strong(program, -1);
+	}
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+#include "NoisePlethoraPlugin.hpp"
+#include "Banks.hpp"
+
+/**
+ * Small per-section cache of NoisePlethora algorithms, created on first use and evicted least recently
+ * used first, so only a handful of programs are ever held in memory.
+ *
+ * All allocation (and deallocation) happens off the audio thread: programs chosen from the UI/patch are
+ * created by preload() on the calling thread, and programs the audio thread asks for (knob or CV changes)
+ * are created by a loader thread shared by all pools, and handed over through lock-free slots. Until a
+ * requested program has arrived, acquire() returns nullptr and the caller keeps playing what it has.
+ *
+ * Programs are initialised where they're created, so one that hasn't been played yet starts without any work
+ * on the audio thread. prefetch() has programs likely to be wanted soon (e.g. the neighbours of the current
+ * one) made ready in the background, replacing cached ones that have already been played.
+ *
+ * Programs are identified by their id (see getProgramId()), -1 being none.
+ *
+ * Each program's noise sources are seeded from the pool's seed and the program, so a program created (or
+ * recreated) from the same seed plays the same, e.g. for repeatable renders.
+ */
+class AlgorithmPool {
+public:
+	// cached programs per pool (at least 2, as the active and previous programs are never evicted)
+	static constexpr int capacity = 4;
+	// programs requested from the loader at once: one acquired, and two prefetched
+	static constexpr int numRequests = 3;
+
+	AlgorithmPool();
+	~AlgorithmPool();
+
+	AlgorithmPool(const AlgorithmPool&) = delete;
+	AlgorithmPool& operator=(const AlgorithmPool&) = delete;
+
+	/**
+	 * Audio thread only: returns the algorithm for `program` (which becomes the active one, and the active one
+	 * the previous one), initialised and ready to play, or nullptr if it isn't loaded yet, in which case it's
+	 * requested from the loader thread.
+	 */
+	NoisePlethoraPlugin* acquire(int program);
+
+	/**
+	 * Audio thread only: unless `program` is cached and hasn't been played yet, has the loader thread create
+	 * and initialise it (if there's a request slot free, else try again later)
+	 */
+	void prefetch(int program);
+
+	/** Audio thread only: the previous algorithm is no longer played (e.g. has faded out), and so may be replaced */
+	void releasePrevious();
+
+	/**
+	 * Not for the audio thread: creates the algorithm for `program` now, so that acquire() will find it (replacing a
+	 * cached copy, unless it's the active or previous algorithm)
+	 */
+	void preload(int program);
+
+	/** Seeds algorithms created from now on (those cached already keep their seed) */
+	void setSeed(uint64_t seed) {
+		this->seed = seed;
+	}
+
+private:
+	friend struct AlgorithmLoader;
+
+	struct Entry {
+		int program = -1;
+		NoisePlethoraPlugin* algorithm = nullptr;
+		uint32_t lastUsed = 0;
+		float readySampleRate = 0.f; 	// sample rate it was initialised for, 0 once it's been played
+	};
+	// audio thread only
+	std::array<Entry, capacity> entries;
+	NoisePlethoraPlugin* active = nullptr;
+	NoisePlethoraPlugin* previous = nullptr;
+	uint32_t clock = 0;
+
+	// audio thread -> loader, the first slot for acquire(), the others for prefetch(); cleared by the loader
+	// once delivered, so a program is always either requested, delivered or cached
+	std::array<std::atomic<int>, numRequests> requests;
+	// preload() or loader -> audio thread, each slot claimed by a producer before it's filled
+	struct Delivery {
+		std::atomic<int> state{EMPTY};
+		int program = -1;
+		NoisePlethoraPlugin* algorithm = nullptr;
+		float sampleRate = 0.f;
+	};
+	enum DeliveryState {
+		EMPTY,
+		CLAIMED,
+		FULL
+	};
+	std::array<Delivery, capacity> deliveries;
+	// audio thread -> loader, algorithms to be deleted
+	std::array<std::atomic<NoisePlethoraPlugin*>, capacity> retired{};
+	// any thread -> loader
+	std::atomic<uint64_t> seed{0};
+
+	void collectDeliveries();
+	bool retire(NoisePlethoraPlugin* algorithm);
+	bool isRequested(int program) const;
+	bool deliver(int program, NoisePlethoraPlugin* algorithm, float sampleRate);
+	// loader thread
+	void serviceRequests();
+};
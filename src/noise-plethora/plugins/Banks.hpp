@@ -5,41 +5,60 @@
 #include <memory>
 #include <array>
 
+class NoisePlethoraPlugin;
+
 static const int programsPerBank = 10;
 static const int numBanks = 3;
+// programs are identified by their index in the (dense) table of all banks' programs
+static const int numPrograms = numBanks * programsPerBank;
 
 struct Bank {
 
 	struct BankElem {
-		BankElem() {};
-
-		BankElem(std::string n, float g = 1.0)
-			: name{n}
-			, gain{g}
-		{}
-
-		std::string name = "";
+		std::string_view name = "";
 		float gain = 1.0;
+		NoisePlethoraPlugin* (*create)() = nullptr; 	// new instance of the program
 	};
 
-	static const BankElem defaultElem;
+	// the bank's programs, the rest are empty
+	template <typename... Programs>
+	constexpr Bank(const Programs&... p)
+		: programs{p...}
+		, size(sizeof...(Programs))
+	{}
+
+	constexpr const BankElem& getProgram(int i) const {
+		return programs[i];
+	}
 
-	Bank();
-	Bank(const BankElem& p1, const BankElem& p2 = defaultElem,
-	     const BankElem& p3 = defaultElem, const BankElem& p4 = defaultElem,
-	     const BankElem& p5 = defaultElem, const BankElem& p6 = defaultElem,
-	     const BankElem& p7 = defaultElem, const BankElem& p8 = defaultElem,
-	     const BankElem& p9 = defaultElem, const BankElem& p10 = defaultElem);
+	constexpr std::string_view getProgramName(int i) const {
+		return (i >= 0 && i < programsPerBank) ? programs[i].name : "";
+	}
 
-	std::string_view getProgramName(int i);
-	float getProgramGain(int i);
+	constexpr float getProgramGain(int i) const {
+		return (i >= 0 && i < programsPerBank) ? programs[i].gain : 1.0;
+	}
 
-	int getSize();
+	constexpr int getSize() const {
+		return size;
+	}
 
 private:
 
 	std::array<BankElem, programsPerBank> programs;
+	int size;
 
 };
 
-Bank& getBankForIndex(int i);
+const Bank& getBankForIndex(int i);
+
+inline int getProgramId(int bank, int program) {
+	return bank * programsPerBank + program;
+}
+
+inline std::string_view getProgramNameForId(int id) {
+	return getBankForIndex(id / programsPerBank).getProgramName(id % programsPerBank);
+}
+
+// a new instance of the program (nullptr if there isn't one for the id)
+NoisePlethoraPlugin* createProgram(int id);
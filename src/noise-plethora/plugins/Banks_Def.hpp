@@ -1,48 +1,50 @@
 #pragma once
 
+// PROGRAM(class, gain), see Banks.cpp
+
 #define BANKS_DEF_1 { \
-		{ "radioOhNo", 1.0 }, \
-		{ "Rwalk_SineFMFlange", 1.0 }, \
-		{ "xModRingSqr", 1.0 }, \
-		{ "XModRingSine", 1.0 }, \
-		{ "CrossModRing", 1.0 }, \
-		{ "resonoise", 1.0 }, \
-		{ "grainGlitch", 1.0 }, \
-		{ "grainGlitchII", 1.0 }, \
-		{ "grainGlitchIII", 1.0 }, \
-		{ "basurilla", 1.0 } \
+		PROGRAM(radioOhNo, 1.0), \
+		PROGRAM(Rwalk_SineFMFlange, 1.0), \
+		PROGRAM(xModRingSqr, 1.0), \
+		PROGRAM(XModRingSine, 1.0), \
+		PROGRAM(CrossModRing, 1.0), \
+		PROGRAM(resonoise, 1.0), \
+		PROGRAM(grainGlitch, 1.0), \
+		PROGRAM(grainGlitchII, 1.0), \
+		PROGRAM(grainGlitchIII, 1.0), \
+		PROGRAM(basurilla, 1.0) \
 	}
 
 #define BANKS_DEF_2 { \
-		{ "clusterSaw", 1.0 }, \
-		{ "pwCluster", 1.0 }, \
-		{ "crCluster2", 1.0 }, \
-		{ "sineFMcluster", 1.0 }, \
-		{ "TriFMcluster", 1.0 }, \
-		{ "PrimeCluster", 0.8 }, \
-		{ "PrimeCnoise", 0.8 }, \
-		{ "FibonacciCluster", 1.0 }, \
-		{ "partialCluster", 1.0 }, \
-		{ "phasingCluster", 1.0 } \
+		PROGRAM(clusterSaw, 1.0), \
+		PROGRAM(pwCluster, 1.0), \
+		PROGRAM(crCluster2, 1.0), \
+		PROGRAM(sineFMcluster, 1.0), \
+		PROGRAM(TriFMcluster, 1.0), \
+		PROGRAM(PrimeCluster, 0.8), \
+		PROGRAM(PrimeCnoise, 0.8), \
+		PROGRAM(FibonacciCluster, 1.0), \
+		PROGRAM(partialCluster, 1.0), \
+		PROGRAM(phasingCluster, 1.0) \
 	}
 
 #define BANKS_DEF_3 { \
-		{ "BasuraTotal", 1.0 }, \
-		{ "Atari", 1.0 },  \
-		{ "WalkingFilomena", 1.0 }, \
-		{ "S_H", 1.0 }, \
-		{ "arrayOnTheRocks", 1.0 }, \
-		{ "existencelsPain", 1.0 }, \
-		{ "whoKnows", 1.0 }, \
-		{ "satanWorkout", 1.0 }, \
-		{ "Rwalk_BitCrushPW", 1.0 }, \
-		{ "Rwalk_LFree", 1.0 } \
+		PROGRAM(BasuraTotal, 1.0), \
+		PROGRAM(Atari, 1.0),  \
+		PROGRAM(WalkingFilomena, 1.0), \
+		PROGRAM(S_H, 1.0), \
+		PROGRAM(arrayOnTheRocks, 1.0), \
+		PROGRAM(existencelsPain, 1.0), \
+		PROGRAM(whoKnows, 1.0), \
+		PROGRAM(satanWorkout, 1.0), \
+		PROGRAM(Rwalk_BitCrushPW, 1.0), \
+		PROGRAM(Rwalk_LFree, 1.0) \
 	}
 
 #define BANKS_DEF_4 { \
-		{ "TestPlugin", 1.0 }, \
-		{ "WhiteNoise", 1.0 }, \
-		{ "TeensyAlt", 1.0 }  \
+		PROGRAM(TestPlugin, 1.0), \
+		PROGRAM(WhiteNoise, 1.0), \
+		PROGRAM(TeensyAlt, 1.0)  \
 	}
 #define BANKS_DEF_5
 
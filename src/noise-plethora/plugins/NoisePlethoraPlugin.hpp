@@ -1,10 +1,6 @@
 #pragma once
 
 #include <rack.hpp>
-#include <memory>
-#include <string> // string might not be allowed
-#include <functional>
-#include <map>
 
 #include "../teensy/TeensyAudioReplacements.hpp"
 
@@ -22,7 +18,7 @@ public:
 	// equivelent to arduino void loop()
 	virtual void process(float k1, float k2) {};
 
-	// called once-per sample, will consume a buffer of length AUDIO_BLOCK_SAMPLES (128)
+	// called once-per sample, will consume a buffer of length teensy::blockSamples() (up to AUDIO_BLOCK_SAMPLES)
 	// then request that the buffer be refilled, returns values in range [-1, 1]
 	float processGraph() {
 
@@ -33,6 +29,27 @@ public:
 		return int16_to_float_1v(blockBuffer.shift());
 	}
 
+	// renders the next block now, dropping what's left of the current one, and skips its first samples (so that
+	// several algorithms can be kept in step, see NoisePlethora::renderBlocks())
+	void renderBlock(int skip = 0) {
+		blockBuffer.clear();
+		processGraphAsBlock(blockBuffer);
+		for (int i = 0; i < skip && !blockBuffer.empty(); i++) {
+			blockBuffer.shift();
+		}
+	}
+
+	// renders the block after the current one, which is left to play out, e.g. on another thread while this one
+	// plays the current block (see NoisePlethora::renderBlocksAhead())
+	void renderNextBlock() {
+		processGraphAsBlock(blockBuffer);
+	}
+
+	// samples rendered but not yet played
+	int getBufferedSamples() const {
+		return blockBuffer.size();
+	}
+
 	virtual AudioStream& getStream() = 0;
 	virtual unsigned char getPort() = 0;
 
@@ -42,49 +59,8 @@ protected:
 	virtual void processGraphAsBlock(TeensyBuffer& blockBuffer) = 0;
 
 	TeensyBuffer blockBuffer;
-};
-
-
-class MyFactory {
-public:
-	static MyFactory* Instance() {
-		static MyFactory factory;
-		return &factory;
-	}
-
-	std::shared_ptr<NoisePlethoraPlugin> Create(std::string name) {
-		NoisePlethoraPlugin* instance = nullptr;
 
-		// find name in the registry and call factory method.
-		auto it = factoryFunctionRegistry.find(name);
-		if (it != factoryFunctionRegistry.end()) {
-			instance = it->second();
-		}
-
-		// wrap instance in a shared ptr and return
-		if (instance != nullptr) {
-			return std::shared_ptr<NoisePlethoraPlugin>(instance);
-		}
-		else {
-			return nullptr;
-		}
-	}
-
-	void RegisterFactoryFunction(std::string name, std::function<NoisePlethoraPlugin*(void)> classFactoryFunction) {
-		// register the class factory function
-		factoryFunctionRegistry[name] = classFactoryFunction;
-	}
-
-	std::map<std::string, std::function<NoisePlethoraPlugin*(void)>> factoryFunctionRegistry;
-};
-
-template<class T> class Registrar {
-public:
-	Registrar(std::string className) {
-		// register the class factory function
-		MyFactory::Instance()->RegisterFactoryFunction(className,
-		    [](void) -> NoisePlethoraPlugin * { return new T();});
-	}
+	// for the programs' own randomness (e.g. random walks), seeded as the primitives' noise sources are, so
+	// programs created from the same seed play the same
+	teensy::Random random;
 };
-
-#define REGISTER_PLUGIN(NAME) static Registrar<NAME> NAME ##_reg(#NAME)
\ No newline at end of file
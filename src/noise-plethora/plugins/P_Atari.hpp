@@ -44,7 +44,7 @@ public:
 		// waveformMod2 has PWM from waveformMod1
 		waveformMod2.update(nullptr, &output1, &output2);
 
-		blockBuffer.pushBuffer(output2.data, AUDIO_BLOCK_SAMPLES);
+		blockBuffer.pushBuffer(output2.data, teensy::blockSamples());
 	}
 
 	AudioStream& getStream() override {
@@ -66,5 +66,3 @@ private:
 	//AudioConnection          patchCord3;
 
 };
-
-REGISTER_PLUGIN(Atari);
@@ -44,13 +44,13 @@ public:
 
 	void processGraphAsBlock(TeensyBuffer& blockBuffer) override {
 
-		const float blockTime = APP->engine->getSampleTime() * AUDIO_BLOCK_SAMPLES;
+		const float blockTime = APP->engine->getSampleTime() * teensy::blockSamples();
 		timer.process(blockTime);
 
 		waveformMod1.update(nullptr, nullptr, &waveformOut);
 		freeverb1.update(&waveformOut, &freeverbOut);
 
-		blockBuffer.pushBuffer(freeverbOut.data, AUDIO_BLOCK_SAMPLES);
+		blockBuffer.pushBuffer(freeverbOut.data, teensy::blockSamples());
 	}
 
 	AudioStream& getStream() override {
@@ -62,23 +62,9 @@ public:
 
 private:
 
-	static unsigned int generateNoise() {
-		// See https://en.wikipedia.org/wiki/Linear_feedback_shift_register#Galois_LFSRs
-		/* initialize with any 32 bit non-zero  unsigned long value. */
-		static unsigned long int lfsr = 0xfeddfaceUL; /* 32 bit init, nonzero */
-		static unsigned long mask = ((unsigned long)(1UL << 31 | 1UL << 15 | 1UL << 2 | 1UL << 1));
-		/* If the output bit is 1, apply toggle mask.
-		 * The value has 1 at bits corresponding
-		 * to taps, 0 elsewhere. */
-
-		if (lfsr & 1) {
-			lfsr = (lfsr >> 1) ^ mask;
-			return (1);
-		}
-		else {
-			lfsr >>= 1;
-			return (0);
-		}
+	// a random bit (the original uses a Galois LFSR, shared by all instances)
+	unsigned int generateNoise() {
+		return random.next() >> 31;
 	}
 
 	audio_block_t waveformOut, freeverbOut;
@@ -88,5 +74,3 @@ private:
 	// AudioConnection             patchCord1;
 	// unsigned long               lastClick;
 };
-
-REGISTER_PLUGIN(BasuraTotal);
\ No newline at end of file
@@ -80,7 +80,7 @@ public:
 		multiply2.update(&waveformModOut[2], &waveformModOut[3], &multiplyOut[1]);
 		multiply3.update(&multiplyOut[0], &multiplyOut[1], &multiplyOut[2]);
 
-		blockBuffer.pushBuffer(multiplyOut[2].data, AUDIO_BLOCK_SAMPLES);
+		blockBuffer.pushBuffer(multiplyOut[2].data, teensy::blockSamples());
 	}
 
 	AudioStream& getStream() override {
@@ -115,5 +115,3 @@ private:
 	// AudioConnection          patchCord10(multiply1, 0, multiply3, 0);
 
 };
-
-REGISTER_PLUGIN(CrossModRing);
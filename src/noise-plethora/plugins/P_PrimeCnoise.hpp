@@ -149,7 +149,7 @@ public:
 
 		mixer5.update(&mixerOut[0], &mixerOut[1], &mixerOut[2], &mixerOut[3], &mixerOut[4]);
 
-		blockBuffer.pushBuffer(mixerOut[4].data, AUDIO_BLOCK_SAMPLES);
+		blockBuffer.pushBuffer(mixerOut[4].data, teensy::blockSamples());
 	}
 
 	AudioStream& getStream() override {
@@ -244,5 +244,3 @@ private:
 	// AudioConnection          patchCord35;
 	// AudioConnection          patchCord36;
 };
-
-REGISTER_PLUGIN(PrimeCnoise);
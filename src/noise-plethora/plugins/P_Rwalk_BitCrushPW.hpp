@@ -82,12 +82,12 @@ public:
 		// random walk initial conditions
 		for (int i = 0; i < 9; i++) {
 			// velocities: initial conditions in -pi : +pi
-			theta = M_PI * (random::uniform() * 2.0 - 1.0);
+			theta = M_PI * (random.uniform() * 2.0 - 1.0);
 			vx[i] = std::cos(theta);
 			vy[i] = std::sin(theta);
 			// positions: random in [0,L] x [0, L]
-			x[i] = random::uniform() * L;
-			y[i] = random::uniform() * L;
+			x[i] = random.uniform() * L;
+			y[i] = random.uniform() * L;
 
 		}
 	}
@@ -113,7 +113,7 @@ public:
 
 		// loop to "walk" randomly
 		for (int i = 0; i < 9; i++) {
-			theta = M_PI * (random::uniform() * 2.0 - 1.0);
+			theta = M_PI * (random.uniform() * 2.0 - 1.0);
 
 			posx = std::cos(theta);
 			vx[i] = posx;
@@ -193,7 +193,7 @@ public:
 		// finally sum bitcrush and freeverb
 		mixer7.update(&bitcrushBlock, &freeverbBlock, nullptr, nullptr, &mixerBlock[3]);
 
-		blockBuffer.pushBuffer(mixerBlock[3].data, AUDIO_BLOCK_SAMPLES);
+		blockBuffer.pushBuffer(mixerBlock[3].data, teensy::blockSamples());
 	}
 
 	AudioStream& getStream() override {
@@ -254,5 +254,3 @@ private:
 	float x[9], y[9], vx[9], vy[9]; // number depends on waveforms declared
 
 };
-
-REGISTER_PLUGIN(Rwalk_BitCrushPW); // this is important, so that we can include the plugin in a bank
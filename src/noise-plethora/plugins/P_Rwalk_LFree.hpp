@@ -46,12 +46,12 @@ public:
 		// random walk initial conditions
 		for (int i = 0; i < 4; i++) {
 			// velocities: initial conditions in -pi : +pi
-			theta = M_PI * (random::uniform() * 2.0 - 1.0);
+			theta = M_PI * (random.uniform() * 2.0 - 1.0);
 			vx[i] = std::cos(theta);
 			vy[i] = std::sin(theta);
 			// positions: random in [0,L] x [0, L]
-			x[i] = random::uniform() * L;
-			y[i] = random::uniform() * L;
+			x[i] = random.uniform() * L;
+			y[i] = random.uniform() * L;
 		}
 	}
 
@@ -70,7 +70,7 @@ public:
 
 		// loop to "walk" randomly
 		for (int i = 0; i < 4; i++) {
-			theta = M_PI * (random::uniform() * 2.0 - 1.0);
+			theta = M_PI * (random.uniform() * 2.0 - 1.0);
 
 			posx = std::cos(theta);
 			vx[i] = posx;
@@ -113,7 +113,7 @@ public:
 		mixer5.update(&pwmBlock[0], &pwmBlock[1], &pwmBlock[2], &pwmBlock[3], &mixerBlock);
 		freeverb1.update(&mixerBlock, &freeverbBlock);
 
-		blockBuffer.pushBuffer(freeverbBlock.data, AUDIO_BLOCK_SAMPLES);
+		blockBuffer.pushBuffer(freeverbBlock.data, teensy::blockSamples());
 	}
 
 	AudioStream& getStream() override {
@@ -152,5 +152,3 @@ private:
 	float x[4], y[4], vx[4], vy[4]; // number depends on waveforms declared
 
 };
-
-REGISTER_PLUGIN(Rwalk_LFree); // this is important, so that we can include the plugin in a bank
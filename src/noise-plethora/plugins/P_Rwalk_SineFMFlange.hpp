@@ -60,12 +60,12 @@ public:
 		// random walk initial conditions
 		for (int i = 0; i < 4; i++) {
 			// velocities: initial conditions in -pi : +pi
-			theta = M_PI * (random::uniform() * (2.0) - 1.0);
+			theta = M_PI * (random.uniform() * (2.0) - 1.0);
 			vx[i] = cos(theta);
 			vy[i] = sin(theta);
 			// positions: random in [0,L] x [0, L]
-			x[i] = random::uniform() * (L);
-			y[i] = random::uniform() * (L);
+			x[i] = random.uniform() * (L);
+			y[i] = random.uniform() * (L);
 		}
 	}
 
@@ -87,7 +87,7 @@ public:
 
 		// loop to "walk" randomly
 		for (int i = 0; i < 4; i++) {
-			theta = M_PI * (random::uniform() * (2.0) - 1.0);
+			theta = M_PI * (random.uniform() * (2.0) - 1.0);
 
 			posx = cos(theta);
 			vx[i] = posx;
@@ -144,7 +144,7 @@ public:
 		mixer1.update(&sineFMBlock[0], &sineFMBlock[1], &sineFMBlock[2], &sineFMBlock[3], &mixerBlock);
 		flange1.update(&mixerBlock, &flangeBlock);
 
-		blockBuffer.pushBuffer(flangeBlock.data, AUDIO_BLOCK_SAMPLES);
+		blockBuffer.pushBuffer(flangeBlock.data, teensy::blockSamples());
 	}
 
 	AudioStream& getStream() override {
@@ -195,5 +195,3 @@ private:
 	double mod_freq;
 
 };
-
-REGISTER_PLUGIN(Rwalk_SineFMFlange); // this is important, so that we can include the plugin in a bank
@@ -39,7 +39,7 @@ public:
 		freeverb1.update(&waveformModBlock, &freeverbBlock);
 		mixer1.update(&waveformModBlock, &freeverbBlock, nullptr, nullptr, &mixerBlock);
 
-		blockBuffer.pushBuffer(mixerBlock.data, AUDIO_BLOCK_SAMPLES);
+		blockBuffer.pushBuffer(mixerBlock.data, teensy::blockSamples());
 	}
 
 	AudioStream& getStream() override {
@@ -61,5 +61,3 @@ private:
 	//AudioConnection          patchCord3(freeverb1, 0, mixer1, 1);
 
 };
-
-REGISTER_PLUGIN(S_H);
@@ -41,7 +41,7 @@ public:
 		waveform1.update(&output1);
 		filter1.update(&output1, nullptr, &filterOutLP, &filterOutBP, &filterOutHP);
 
-		blockBuffer.pushBuffer(filterOutBP.data, AUDIO_BLOCK_SAMPLES);
+		blockBuffer.pushBuffer(filterOutBP.data, teensy::blockSamples());
 	}
 
 	AudioStream& getStream() override {
@@ -60,5 +60,3 @@ private:
 	AudioFilterStateVariable filter1;        //xy=1062.2726001739502,460.8181266784668
 
 };
-
-REGISTER_PLUGIN(TeensyAlt);
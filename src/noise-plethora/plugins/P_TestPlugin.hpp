@@ -58,7 +58,7 @@ public:
 
 		// waveformMod1
 		waveform1.update(nullptr, nullptr, &waveformOut);
-		blockBuffer.pushBuffer(waveformOut.data, AUDIO_BLOCK_SAMPLES);
+		blockBuffer.pushBuffer(waveformOut.data, teensy::blockSamples());
 	}
 
 	AudioStream& getStream() override {
@@ -80,6 +80,3 @@ private:
 	//AudioConnection          patchCord3;
 
 };
-
-
-REGISTER_PLUGIN(TestPlugin);
\ No newline at end of file
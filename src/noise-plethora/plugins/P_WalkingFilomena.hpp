@@ -116,12 +116,12 @@ public:
 		// random walk initial conditions
 		for (int i = 0; i < 16; i++) {
 			// velocities: initial conditions in -pi : +pi
-			theta = M_PI * (random::uniform() * 2.0 - 1.0);
+			theta = M_PI * (random.uniform() * 2.0 - 1.0);
 			vx[i] = std::cos(theta);
 			vy[i] = std::sin(theta);
 			// positions: random in [0,L] x [0, L]
-			x[i] = random::uniform() * L;
-			y[i] = random::uniform() * L;
+			x[i] = random.uniform() * L;
+			y[i] = random.uniform() * L;
 
 		}
 	}
@@ -143,7 +143,7 @@ public:
 
 		// loop to "walk" randomly
 		for (int i = 0; i < 16; i++) {
-			theta = M_PI * (random::uniform() * 2.0 - 1.0);
+			theta = M_PI * (random.uniform() * 2.0 - 1.0);
 
 			posx = std::cos(theta);
 			vx[i] = posx;
@@ -235,7 +235,7 @@ public:
 		mixer4.update(&waveformBlock[12], &waveformBlock[13], &waveformBlock[14], &waveformBlock[15], &mixBlock[3]);
 
 		mixer5.update(&mixBlock[0], &mixBlock[1], &mixBlock[2], &mixBlock[3], &mixBlock[4]);
-		blockBuffer.pushBuffer(mixBlock[4].data, AUDIO_BLOCK_SAMPLES);
+		blockBuffer.pushBuffer(mixBlock[4].data, teensy::blockSamples());
 	}
 
 	AudioStream& getStream() override {
@@ -301,5 +301,3 @@ private:
 	float x[16], y[16], vx[16], vy[16]; // number depends on waveforms declared
 
 };
-
-REGISTER_PLUGIN(WalkingFilomena); // this is important, so that we can include the plugin in a bank
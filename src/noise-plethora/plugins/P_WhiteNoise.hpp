@@ -26,7 +26,7 @@ public:
 
 	void processGraphAsBlock(TeensyBuffer& blockBuffer) override {
 		noise1.update(&noiseOut);
-		blockBuffer.pushBuffer(noiseOut.data, AUDIO_BLOCK_SAMPLES);
+		blockBuffer.pushBuffer(noiseOut.data, teensy::blockSamples());
 	}
 
 	AudioStream& getStream() override {
@@ -45,5 +45,3 @@ private:
 	AudioSynthNoiseWhite noise1;
 
 };
-
-REGISTER_PLUGIN(WhiteNoise);
@@ -51,7 +51,7 @@ public:
 
 		multiply1.update(&sineModOut[0], &sineModOut[1], &multiplyOut);
 
-		blockBuffer.pushBuffer(multiplyOut.data, AUDIO_BLOCK_SAMPLES);
+		blockBuffer.pushBuffer(multiplyOut.data, teensy::blockSamples());
 	}
 
 
@@ -76,5 +76,3 @@ private:
 	// AudioConnection          patchCord3;
 	// AudioConnection          patchCord4;
 };
-
-REGISTER_PLUGIN(XModRingSine); // this is important, so that we can include the plugin in a bank
@@ -73,7 +73,7 @@ public:
 		waveform1.update(&waveformBlock);
 		waveformMod1.update(&waveformBlock, nullptr, &waveformModBlock);
 
-		blockBuffer.pushBuffer(waveformModBlock.data, AUDIO_BLOCK_SAMPLES);
+		blockBuffer.pushBuffer(waveformModBlock.data, teensy::blockSamples());
 	}
 
 	AudioStream& getStream() override {
@@ -128,10 +128,3 @@ private:
 
 
 };
-
-
-
-
-
-
-REGISTER_PLUGIN(arrayOnTheRocks); // this is important, so that we can include the plugin in a bank
@@ -69,7 +69,7 @@ public:
 		// NOTE: 2,3 not actually used, as volume is 0 in init()!
 		// mixer1.update(&multiplyOut[0], &multiplyOut[1], &multiplyOut[2], nullptr, &mixerOut);
 
-		blockBuffer.pushBuffer(multiplyOut[0].data, AUDIO_BLOCK_SAMPLES);
+		blockBuffer.pushBuffer(multiplyOut[0].data, teensy::blockSamples());
 	}
 
 	AudioStream& getStream() override {
@@ -104,5 +104,3 @@ private:
 	//
 
 };
-
-REGISTER_PLUGIN(basurilla);
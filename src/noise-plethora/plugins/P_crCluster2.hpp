@@ -93,7 +93,7 @@ public:
 		mixer2.update(&waveformModOut[4], &waveformModOut[5], nullptr, nullptr, &mixerOut[1]);
 		mixer5.update(&mixerOut[0], &mixerOut[1], nullptr, nullptr, &mixerOut[2]);
 
-		blockBuffer.pushBuffer(mixerOut[2].data, AUDIO_BLOCK_SAMPLES);
+		blockBuffer.pushBuffer(mixerOut[2].data, teensy::blockSamples());
 	}
 
 	AudioStream& getStream() override {
@@ -131,5 +131,3 @@ private:
 	// AudioConnection          patchCord13;
 	// AudioConnection          patchCord14;
 };
-
-REGISTER_PLUGIN(crCluster2);
@@ -101,7 +101,7 @@ public:
 		// sum up
 		mixer1.update(&filterOutBP[0], &filterOutBP[1], &filterOutBP[2], &filterOutBP[3], &mixerOut);
 
-		blockBuffer.pushBuffer(mixerOut.data, AUDIO_BLOCK_SAMPLES);
+		blockBuffer.pushBuffer(mixerOut.data, teensy::blockSamples());
 	}
 
 	AudioStream& getStream() override {
@@ -142,5 +142,3 @@ private:
 	// AudioConnection          patchCord12;
 
 };
-
-REGISTER_PLUGIN(existencelsPain); // this is important, so that we can include the plugin in a bank
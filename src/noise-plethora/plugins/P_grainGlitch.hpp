@@ -61,7 +61,7 @@ public:
 
 		combine1.update(&granularOut, &waveformMod1Out, &combine1Out);
 
-		blockBuffer.pushBuffer(combine1Out.data, AUDIO_BLOCK_SAMPLES);
+		blockBuffer.pushBuffer(combine1Out.data, teensy::blockSamples());
 	}
 
 	AudioStream& getStream() override {
@@ -87,5 +87,3 @@ private:
 	audio_block_t waveformMod1Out;
 	audio_block_t combine1Out;
 };
-
-REGISTER_PLUGIN(grainGlitch);
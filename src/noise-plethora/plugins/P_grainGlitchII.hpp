@@ -53,7 +53,7 @@ public:
 
 		amp1.update(&granularOut);
 
-		blockBuffer.pushBuffer(granularOut.data, AUDIO_BLOCK_SAMPLES);
+		blockBuffer.pushBuffer(granularOut.data, teensy::blockSamples());
 	}
 
 	AudioStream& getStream() override {
@@ -74,5 +74,3 @@ private:
 
 	audio_block_t granularOut, waveformMod1Out;
 };
-
-REGISTER_PLUGIN(grainGlitchII);
@@ -50,7 +50,7 @@ public:
 
 		waveformMod1.update(&granularOut, nullptr, &waveformMod1Previous);
 
-		blockBuffer.pushBuffer(granularOut.data, AUDIO_BLOCK_SAMPLES);
+		blockBuffer.pushBuffer(granularOut.data, teensy::blockSamples());
 	}
 
 	AudioStream& getStream() override {
@@ -70,5 +70,3 @@ private:
 	audio_block_t granularOut;
 	audio_block_t waveformMod1Previous;
 };
-
-REGISTER_PLUGIN(grainGlitchIII);
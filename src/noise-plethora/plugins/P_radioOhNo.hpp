@@ -61,7 +61,7 @@ public:
 
 		mixer1.update(&waveformModPrevious[1], &waveformModPrevious[3], nullptr, nullptr, &mixerOut);
 
-		blockBuffer.pushBuffer(mixerOut.data, AUDIO_BLOCK_SAMPLES);
+		blockBuffer.pushBuffer(mixerOut.data, teensy::blockSamples());
 
 	}
 
@@ -95,5 +95,3 @@ private:
 	// AudioConnection          patchCord9;
 	// AudioConnection          patchCord10;
 };
-
-REGISTER_PLUGIN(radioOhNo);
@@ -61,7 +61,7 @@ public:
 		noise1.update(&noiseBlock);
 		filter1.update(&noiseBlock, &wavefolderBlock, &filterOutLP, &filterOutBP, &filterOutHP);
 
-		blockBuffer.pushBuffer(filterOutLP.data, AUDIO_BLOCK_SAMPLES);
+		blockBuffer.pushBuffer(filterOutLP.data, teensy::blockSamples());
 	}
 
 	AudioStream& getStream() override {
@@ -91,5 +91,3 @@ private:
 	// AudioConnection          patchCord5;
 
 };
-
-REGISTER_PLUGIN(resonoise); // this is important, so that we can include the plugin in a bank
@@ -48,7 +48,7 @@ public:
 		pwm1.update(&noiseBlock, &pwmBlock);
 		freeverb1.update(&pwmBlock, &freeverbBlock);
 
-		blockBuffer.pushBuffer(freeverbBlock.data, AUDIO_BLOCK_SAMPLES);
+		blockBuffer.pushBuffer(freeverbBlock.data, teensy::blockSamples());
 	}
 
 	AudioStream& getStream() override {
@@ -70,5 +70,3 @@ private:
 
 
 };
-
-REGISTER_PLUGIN(satanWorkout); // this is important, so that we can include the plugin in a bank
@@ -102,7 +102,7 @@ public:
 		// sum up
 		mixer1.update(&filterOutBP[0], &filterOutBP[1], &filterOutBP[2], &filterOutBP[3], &mixerOut);
 
-		blockBuffer.pushBuffer(mixerOut.data, AUDIO_BLOCK_SAMPLES);
+		blockBuffer.pushBuffer(mixerOut.data, teensy::blockSamples());
 	}
 
 
@@ -144,5 +144,3 @@ private:
 	// AudioConnection          patchCord12;
 
 };
-
-REGISTER_PLUGIN(whoKnows); // this is important, so that we can include the plugin in a bank
@@ -45,7 +45,7 @@ public:
 
 		multiply1.update(&waveformModOut[0], &waveformModOut[1], &multiplyOut);
 
-		blockBuffer.pushBuffer(multiplyOut.data, AUDIO_BLOCK_SAMPLES);
+		blockBuffer.pushBuffer(multiplyOut.data, teensy::blockSamples());
 	}
 
 	AudioStream& getStream() override {
@@ -67,5 +67,3 @@ private:
 	// AudioConnection          patchCord4;
 
 };
-
-REGISTER_PLUGIN(xModRingSqr);
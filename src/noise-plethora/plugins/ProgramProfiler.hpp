@@ -0,0 +1,136 @@
+#pragma once
+
+#include <rack.hpp>
+#include <array>
+#include <chrono>
+#include <cmath>
+
+#include "Banks.hpp"
+
+/**
+ * Rolling histograms of how long each program takes to render its blocks, for picking programs that fit a CPU
+ * budget. Times are per sample (blocks can be any size), in half octave bins from 1ns, and older blocks are
+ * progressively forgotten, so the figures follow the last few seconds of use.
+ *
+ * Recorded on the audio thread, and read (without locking, so only approximately up to date) by the UI.
+ */
+class ProgramProfiler {
+public:
+	static constexpr int numBins = 32;
+	// blocks of a program after which its counts are halved
+	static constexpr int decayBlocks = 2048;
+
+	class Timer {
+	public:
+		Timer() : start(std::chrono::steady_clock::now()) {}
+
+		double getSeconds() const {
+			return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		}
+
+	private:
+		std::chrono::steady_clock::time_point start;
+	};
+
+	void record(int program, double seconds, int numSamples) {
+		if (program < 0 || program >= numPrograms || numSamples <= 0) {
+			return;
+		}
+		Program& p = programs[program];
+		const float ns = 1e9 * seconds / numSamples;
+		p.counts[getBin(ns)] += 1.f;
+		p.numBlocks += 1.f;
+		p.sumNs += ns;
+		if (++p.sinceDecay == decayBlocks) {
+			for (float& count : p.counts) {
+				count *= 0.5f;
+			}
+			p.numBlocks *= 0.5f;
+			p.sumNs *= 0.5f;
+			p.sinceDecay = 0;
+		}
+	}
+
+	void reset() {
+		programs = {};
+	}
+
+	bool hasData(int program) const {
+		return programs[program].numBlocks > 0.f;
+	}
+
+	float getMeanNs(int program) const {
+		const Program& p = programs[program];
+		return p.numBlocks > 0.f ? p.sumNs / p.numBlocks : 0.f;
+	}
+
+	// from the histogram, so to within half an octave (the bin's geometric centre)
+	float getPercentileNs(int program, float percentile) const {
+		const Program& p = programs[program];
+		float below = 0.f;
+		for (int bin = 0; bin < numBins; bin++) {
+			below += p.counts[bin];
+			if (below >= percentile * p.numBlocks) {
+				return getBinCentreNs(bin);
+			}
+		}
+		return getBinCentreNs(numBins - 1);
+	}
+
+	// the share of one core the program would use at the given sample rate
+	static float getCpuPercent(float nsPerSample, float sampleRate) {
+		return 100.f * nsPerSample * 1e-9f * sampleRate;
+	}
+
+	/** Every program profiled so far, by name: mean, median and 95th percentile (ns per sample), CPU (% of one core
+	 * at `sampleRate`) and the histogram */
+	json_t* toJson(float sampleRate) const {
+		json_t* rootJ = json_object();
+		json_t* binsJ = json_array();
+		for (int bin = 0; bin < numBins; bin++) {
+			json_array_append_new(binsJ, json_real(getBinStartNs(bin)));
+		}
+		json_object_set_new(rootJ, "binStartNs", binsJ);
+
+		json_t* programsJ = json_object();
+		for (int program = 0; program < numPrograms; program++) {
+			if (!hasData(program)) {
+				continue;
+			}
+			json_t* programJ = json_object();
+			json_object_set_new(programJ, "meanNs", json_real(getMeanNs(program)));
+			json_object_set_new(programJ, "medianNs", json_real(getPercentileNs(program, 0.5f)));
+			json_object_set_new(programJ, "p95Ns", json_real(getPercentileNs(program, 0.95f)));
+			json_object_set_new(programJ, "cpuPercent", json_real(getCpuPercent(getMeanNs(program), sampleRate)));
+			json_t* countsJ = json_array();
+			for (float count : programs[program].counts) {
+				json_array_append_new(countsJ, json_real(count));
+			}
+			json_object_set_new(programJ, "histogram", countsJ);
+			json_object_set_new(programsJ, std::string(getProgramNameForId(program)).c_str(), programJ);
+		}
+		json_object_set_new(rootJ, "programs", programsJ);
+		return rootJ;
+	}
+
+private:
+	struct Program {
+		std::array<float, numBins> counts{};
+		float numBlocks = 0.f;
+		float sumNs = 0.f;
+		int sinceDecay = 0;
+	};
+	std::array<Program, numPrograms> programs;
+
+	static int getBin(float ns) {
+		return rack::math::clamp((int)(2.f * std::log2(std::max(ns, 1.f))), 0, numBins - 1);
+	}
+
+	static float getBinStartNs(int bin) {
+		return std::exp2(0.5f * bin);
+	}
+
+	static float getBinCentreNs(int bin) {
+		return std::exp2(0.5f * bin + 0.25f);
+	}
+};
@@ -15,7 +15,8 @@ public:
 // w.r.t. aliasing etc - this generally used to put upper bounds on frequencies etc
 #define AUDIO_SAMPLE_RATE_EXACT 44100.0f
 
-typedef rack::dsp::RingBuffer<int16_t, AUDIO_BLOCK_SAMPLES> TeensyBuffer;
+// room for the block being played and the next (see NoisePlethoraPlugin::renderNextBlock())
+typedef rack::dsp::RingBuffer<int16_t, 2 * AUDIO_BLOCK_SAMPLES> TeensyBuffer;
 
 typedef struct audio_block_struct {
 	// uint8_t  ref_count;
@@ -83,35 +84,227 @@ const int16_t AudioWaveformSine[257] = {
 
 namespace teensy {
 
-static uint32_t seed;
-
-inline int32_t random_teensy(void) {
-	int32_t hi, lo, x;
-
-	// the algorithm used in avr-libc 1.6.4
-	x = seed;
-	if (x == 0)
-		x = 123459876;
-	hi = x / 127773;
-	lo = x % 127773;
-	x = 16807 * lo - 2836 * hi;
-	if (x < 0)
-		x += 0x7FFFFFFF;
-	seed = x;
-	return x;
+// SplitMix64, used to turn seeds (which may be consecutive, or mostly zero) into well mixed generator states
+inline uint64_t splitMix64(uint64_t& state) {
+	uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
 }
 
-inline uint32_t random_teensy(uint32_t howbig) {
-	if (howbig == 0)
-		return 0;
-	return random_teensy() % howbig;
+// Seeds for the random number generators constructed on the calling thread, each taking the next of the sequence.
+// Whoever creates a program starts the sequence (see AlgorithmPool), so its generators are seeded the same way every
+// time it's created from the same seed, whichever thread it's created on.
+inline uint64_t& seedSequence() {
+	static thread_local uint64_t sequence = 0;
+	return sequence;
 }
 
-inline int32_t random_teensy(int32_t howsmall, int32_t howbig) {
-	if (howsmall >= howbig)
-		return howsmall;
-	int32_t diff = howbig - howsmall;
-	return random_teensy(diff) + howsmall;
+inline uint64_t nextSeed() {
+	return splitMix64(seedSequence());
+}
+
+// Per-instance xoshiro128+, run as four independent streams (one per SSE lane), so blocks of noise are generated
+// four samples at a time; single values are taken from the last four generated. Only the upper bits are used, as
+// the lowest bits of xoshiro128+ are weak.
+class Random {
+public:
+	Random() {
+		seed(nextSeed());
+	}
+
+	void seed(uint64_t seed) {
+		alignas(16) uint32_t words[16];
+		for (int i = 0; i < 16; i += 2) {
+			const uint64_t z = splitMix64(seed);
+			words[i] = z;
+			words[i + 1] = z >> 32;
+		}
+		for (int k = 0; k < 4; k++) {
+			state[k] = _mm_load_si128((const __m128i*) &words[4 * k]);
+		}
+		position = 4;
+	}
+
+	// four uniformly distributed 32 bit values
+	__m128i next4() {
+		const __m128i result = _mm_add_epi32(state[0], state[3]);
+		const __m128i t = _mm_slli_epi32(state[1], 9);
+		state[2] = _mm_xor_si128(state[2], state[0]);
+		state[3] = _mm_xor_si128(state[3], state[1]);
+		state[1] = _mm_xor_si128(state[1], state[2]);
+		state[0] = _mm_xor_si128(state[0], state[3]);
+		state[2] = _mm_xor_si128(state[2], t);
+		state[3] = _mm_or_si128(_mm_slli_epi32(state[3], 11), _mm_srli_epi32(state[3], 21));
+		return result;
+	}
+
+	uint32_t next() {
+		if (position == 4) {
+			_mm_store_si128((__m128i*) buffered, next4());
+			position = 0;
+		}
+		return buffered[position++];
+	}
+
+	// fills `n` values, n being a multiple of 4
+	void fill(uint32_t* out, int n) {
+		for (int i = 0; i < n; i += 4) {
+			_mm_storeu_si128((__m128i*) &out[i], next4());
+		}
+	}
+
+	// uniform on [0, 1)
+	float uniform() {
+		return (next() >> 8) * (1.f / 16777216.f);
+	}
+
+	// four values uniform on [0, 1)
+	rack::simd::float_4 uniform4() {
+		return rack::simd::float_4(_mm_cvtepi32_ps(_mm_srli_epi32(next4(), 8))) * (1.f / 16777216.f);
+	}
+
+	// uniform on [0, howbig)
+	uint32_t below(uint32_t howbig) {
+		return ((uint64_t) next() * howbig) >> 32;
+	}
+
+private:
+	__m128i state[4];
+	alignas(16) uint32_t buffered[4];
+	int position = 4;
+};
+
+// The primitives with a float implementation (AudioSynthWaveformModulated, AudioSynthWaveformBank,
+// AudioSynthWaveformSineModulated, AudioMixer4, AudioEffectMultiply and AudioFilterStateVariable) either
+// reproduce the Teensy's fixed point arithmetic exactly, or do their maths in float, four samples (or four
+// oscillators) at a time. Blocks passed between primitives are 16 bit in both cases, so programs and the other
+// primitives are unaffected. The mode applies to the calling thread, and is set by the module before it runs
+// its programs.
+enum ProcessingMode {
+	HARDWARE_EXACT,
+	FAST_FLOAT,
+	NUM_PROCESSING_MODES
+};
+
+inline ProcessingMode& processingMode() {
+	static thread_local ProcessingMode mode = HARDWARE_EXACT;
+	return mode;
+}
+
+inline bool fastFloat() {
+	return processingMode() == FAST_FLOAT;
+}
+
+// Samples rendered by each update() of the primitives, and so by each of the programs' processGraphAsBlock().
+// The Teensy always renders AUDIO_BLOCK_SAMPLES (blocks are still allocated at that size), smaller blocks
+// spread the work more evenly over the engine's samples, at some extra cost per block. Always a multiple of
+// MIN_BLOCK_SAMPLES, so the vectorised paths need no remainder loops. As processingMode(), applies to the
+// calling thread.
+static const int MIN_BLOCK_SAMPLES = 8;
+
+inline int& blockSamples() {
+	static thread_local int samples = AUDIO_BLOCK_SAMPLES;
+	return samples;
+}
+
+// A parameter the programs set (from X/Y) once per update, i.e. every AUDIO_BLOCK_SAMPLES at the Teensy's rate. In
+// FAST_FLOAT mode the float paths ramp it linearly from where it was to the new value over that many samples, across
+// however many blocks that takes, so modulation isn't stepped (at the cost of an update period's lag). Otherwise (and
+// for the first value set) it jumps, and the fixed point paths, which never ramp, use the value as set.
+struct ParamRamp {
+	float value = 0.f; 		// at the start of the next block
+	float target = 0.f;
+	float step = 0.f; 		// per sample
+	int remaining = 0; 		// samples until target
+	bool started = false;
+
+	void set(float newTarget) {
+		if (started && newTarget == target) {
+			return;
+		}
+		target = newTarget;
+		if (!started || !fastFloat()) {
+			value = target;
+			remaining = 0;
+			started = true;
+			return;
+		}
+		remaining = AUDIO_BLOCK_SAMPLES;
+		step = (target - value) / AUDIO_BLOCK_SAMPLES;
+	}
+
+	bool isRamping() const {
+		return remaining > 0;
+	}
+
+	// at sample i of the next block
+	float at(int i) const {
+		return (i < remaining) ? value + step * i : target;
+	}
+
+	// at samples i to i + 3
+	rack::simd::float_4 at4(int i) const {
+		const rack::simd::float_4 n = rack::simd::float_4(i, i + 1, i + 2, i + 3);
+		return rack::simd::ifelse(n < (float) remaining, value + step * n, target);
+	}
+
+	// after a block is rendered
+	void advance(int numSamples) {
+		if (numSamples >= remaining) {
+			value = target;
+			remaining = 0;
+		}
+		else {
+			value += step * numSamples;
+			remaining -= numSamples;
+		}
+	}
+};
+
+// four samples of a block, in 16 bit units
+inline rack::simd::float_4 loadBlock4(const int16_t* data) {
+	// sign extended by interleaving each sample with itself, then shifting down (SSE2 only)
+	const __m128i samples = _mm_loadl_epi64((const __m128i*) data);
+	return rack::simd::float_4(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16)));
+}
+
+// phases as signed fractions of a cycle, i.e. [0, 2^32) maps to [0, 1) then [-1, 0)
+inline rack::simd::float_4 phaseToFloat(rack::simd::int32_4 phase) {
+	return rack::simd::float_4(phase) * (1.f / 2147483648.f);
+}
+
+inline rack::simd::float_4 loadPhase4(const uint32_t* phase) {
+	return phaseToFloat(rack::simd::int32_4::load((const int32_t*) phase));
+}
+
+// sin(pi * x) for x in [-1, 1], folded to [-1/2, 1/2] and then a 9th order polynomial (error < 4e-6, well
+// under the 16 bit output's resolution)
+inline rack::simd::float_4 sinPi(rack::simd::float_4 x) {
+	x = rack::simd::ifelse(rack::simd::abs(x) > 0.5f, rack::simd::ifelse(x < 0.f, -1.f, 1.f) - x, x);
+	const rack::simd::float_4 x2 = x * x;
+	return x * (3.14159265f + x2 * (-5.16771278f + x2 * (2.55016404f + x2 * (-0.59926453f + x2 * 0.08214589f))));
+}
+
+// rounds and saturates eight float samples (in 16 bit units) into a block
+inline void storeBlock8(rack::simd::float_4 a, rack::simd::float_4 b, int16_t* out) {
+	// clamped first, as out of range floats convert to INT32_MIN
+	a = rack::simd::clamp(a, -32768.f, 32767.f);
+	b = rack::simd::clamp(b, -32768.f, 32767.f);
+	_mm_storeu_si128((__m128i*) out, _mm_packs_epi32(_mm_cvtps_epi32(a.v), _mm_cvtps_epi32(b.v)));
+}
+
+// as above, for four samples
+inline void storeBlock4(rack::simd::float_4 a, int16_t* out) {
+	const __m128i rounded = _mm_cvtps_epi32(rack::simd::clamp(a, -32768.f, 32767.f).v);
+	_mm_storel_epi64((__m128i*) out, _mm_packs_epi32(rounded, rounded));
+}
+
+inline void floatToBlock(const float* in, int16_t* out) {
+	const int numSamples = blockSamples();
+	for (int i = 0; i < numSamples; i += 8) {
+		storeBlock8(rack::simd::float_4::load(&in[i]), rack::simd::float_4::load(&in[i + 4]), &out[i]);
+	}
 }
 }
 
@@ -126,26 +319,23 @@ public:
 		level_ = level;
 	}
 
+	void seed(uint64_t seed) {
+		random.seed(seed);
+	}
+
 	// uniform on [-1, 1]
 	float process() {
-		return level_ * ((rand31pm_next() / 2147483647.0) * 2.f - 1.f);
+		return level_ * (random.uniform() * 2.f - 1.f);
 	}
 
 	// uniform on [0, 1]
 	float processNonnegative() {
-		return level_ * (rand31pm_next() / 2147483647.0);
-	}
-
-	long unsigned int rand31pm_next() {
-		double const a = 16807;
-		double const m = 2147483647.0  ;
-
-		return (seed31pm = (long)(fmod((seed31pm * a), m)));
+		return level_ * random.uniform();
 	}
 
 private:
 	float level_ = 1.0;
-	long unsigned int seed31pm  = 1;
+	teensy::Random random;
 };
 
 
@@ -157,6 +347,10 @@ public:
 		density_ = density;
 	}
 
+	void seed(uint64_t seed) {
+		white.seed(seed);
+	}
+
 	float process(float sampleTime) {
 
 		float threshold = density_ * sampleTime;
@@ -30,6 +30,7 @@
 #include "effect_bitcrusher.h"
 
 void AudioEffectBitcrusher::update(const audio_block_t* inputBlock, audio_block_t* outputBlock) {
+	const uint32_t numSamples = teensy::blockSamples();
 	uint32_t i;
 	uint32_t sampleSquidge, sampleSqueeze; //squidge is bitdepth, squeeze is for samplerate
 
@@ -43,7 +44,7 @@ void AudioEffectBitcrusher::update(const audio_block_t* inputBlock, audio_block_
 	}
 
 	if (sampleStep <= 1) { //no sample rate mods, just crush the bitdepth.
-		for (i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+		for (i = 0; i < numSamples; i++) {
 			// shift bits right to cut off fine detail sampleSquidge is a
 			// uint32 so sign extension will not occur, fills with zeroes.
 			sampleSquidge = inputBlock->data[i] >> (16 - crushBits);
@@ -54,11 +55,11 @@ void AudioEffectBitcrusher::update(const audio_block_t* inputBlock, audio_block_
 	}
 	else if (crushBits == 16) {   //bitcrusher not being used, samplerate mods only.
 		i = 0;
-		while (i < AUDIO_BLOCK_SAMPLES) {
+		while (i < numSamples) {
 			// save the root sample. this will pick up a root
 			// sample every _sampleStep_ samples.
 			sampleSqueeze = inputBlock->data[i];
-			for (int j = 0; j < sampleStep && i < AUDIO_BLOCK_SAMPLES; j++) {
+			for (int j = 0; j < sampleStep && i < numSamples; j++) {
 				// for each repeated sample, paste in the current
 				// root sample, then move onto the next step.
 				outputBlock->data[i] = sampleSqueeze;
@@ -68,11 +69,11 @@ void AudioEffectBitcrusher::update(const audio_block_t* inputBlock, audio_block_
 	}
 	else {             //both being used. crush those bits and mash those samples.
 		i = 0;
-		while (i < AUDIO_BLOCK_SAMPLES) {
+		while (i < numSamples) {
 			// save the root sample. this will pick up a root sample
 			// every _sampleStep_ samples.
 			sampleSqueeze = inputBlock->data[i];
-			for (int j = 0; j < sampleStep && i < AUDIO_BLOCK_SAMPLES; j++) {
+			for (int j = 0; j < sampleStep && i < numSamples; j++) {
 				// shift bits right to cut off fine detail sampleSquidge
 				// is a uint32 so sign extension will not occur, fills
 				// with zeroes.
@@ -32,6 +32,7 @@
 
 
 void AudioEffectDigitalCombine::update(const audio_block_t* blocka, const audio_block_t* blockb, audio_block_t* output) {
+	const int numSamples = teensy::blockSamples();
 	uint32_t* pa, *pb, *end, *pout;
 	uint32_t a12, a34; //, a56, a78;
 	uint32_t b12, b34; //, b56, b78;
@@ -43,7 +44,7 @@ void AudioEffectDigitalCombine::update(const audio_block_t* blocka, const audio_
 	pa = (uint32_t*)(blocka->data);
 	pb = (uint32_t*)(blockb->data);
 	pout = (uint32_t*)(output->data);
-	end = pa + AUDIO_BLOCK_SAMPLES / 2;
+	end = pa + numSamples / 2;
 
 	while (pa < end) {
 		a12 = *pa++;
@@ -131,6 +131,7 @@ bool AudioEffectFlange::voices(int delay_offset, int d_depth, float delay_rate)
 }
 
 void AudioEffectFlange::update(const audio_block_t* inputBlock, audio_block_t* outputBlock) {
+	const int numSamples = teensy::blockSamples();
 
 	int idx;
 	const short* inbp;
@@ -148,7 +149,7 @@ void AudioEffectFlange::update(const audio_block_t* inputBlock, audio_block_t* o
 		if (inputBlock) {
 			inbp = inputBlock->data;
 			// fill the delay line
-			for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+			for (int i = 0; i < numSamples; i++) {
 				l_circ_idx++;
 				if (l_circ_idx >= delay_length) {
 					l_circ_idx = 0;
@@ -165,7 +166,7 @@ void AudioEffectFlange::update(const audio_block_t* inputBlock, audio_block_t* o
 	if (inputBlock && outputBlock) {
 		inbp = inputBlock->data;
 		outbp = outputBlock->data;
-		for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+		for (int i = 0; i < numSamples; i++) {
 			// increment the index into the circular delay line buffer
 			l_circ_idx++;
 			// wrap the index around if necessary
@@ -93,6 +93,7 @@ static int16_t sat16(int32_t n, int rshift) {
 }
 
 void AudioEffectFreeverb::update(const audio_block_t* block, audio_block_t* outblock) {
+	const int numSamples = teensy::blockSamples();
 	int i;
 	int16_t input, bufout, output;
 	int32_t sum;
@@ -101,7 +102,7 @@ void AudioEffectFreeverb::update(const audio_block_t* block, audio_block_t* outb
 		return;
 	}
 
-	for (i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+	for (i = 0; i < numSamples; i++) {
 		// TODO: scale numerical range depending on roomsize & damping
 		input = sat16(block->data[i] * 8738, 17); // for numerical headroom
 		sum = 0;
@@ -76,6 +76,7 @@ void AudioEffectGranular::stop() {
 }
 
 void AudioEffectGranular::update(const audio_block_t* input_block, audio_block_t* output_block) {
+	const int numSamples = teensy::blockSamples();
 
 
 	if (sample_bank == NULL) {
@@ -92,13 +93,13 @@ void AudioEffectGranular::update(const audio_block_t* input_block, audio_block_t
 
 	if (grain_mode == 0) {
 		// passthrough, no granular effect
-		memcpy(output_block->data, input_block->data, AUDIO_BLOCK_SAMPLES);
+		memcpy(output_block->data, input_block->data, numSamples);
 
 		// prev_input = block->data[AUDIO_BLOCK_SAMPLES - 1];
 	}
 	else if (grain_mode == 1) {
 		// Freeze - sample 1 grain, then repeatedly play it back
-		for (int j = 0; j < AUDIO_BLOCK_SAMPLES; j++) {
+		for (int j = 0; j < numSamples; j++) {
 			if (sample_req) {
 				// only begin capture on zero cross
 				int16_t current_input = input_block->data[j];
@@ -143,7 +144,7 @@ void AudioEffectGranular::update(const audio_block_t* input_block, audio_block_t
 		// Longer it has more definition.  It's a bit roboty either way which
 		// is obv great and good enough for noise music.
 
-		for (int k = 0; k < AUDIO_BLOCK_SAMPLES; k++) {
+		for (int k = 0; k < numSamples; k++) {
 			// only start recording when the audio is crossing zero to minimize pops
 			if (sample_req) {
 				int16_t current_input = input_block->data[k];
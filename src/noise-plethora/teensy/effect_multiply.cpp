@@ -28,6 +28,7 @@
 
 
 void AudioEffectMultiply::update(const audio_block_t* blocka, const audio_block_t* blockb, audio_block_t* blockout) {
+	const int numSamples = teensy::blockSamples();
 
 	const int16_t* pa, *pb, *end;
 	int16_t* out = blockout->data;
@@ -36,9 +37,18 @@ void AudioEffectMultiply::update(const audio_block_t* blocka, const audio_block_
 		return;
 	}
 
+	if (teensy::fastFloat()) {
+		alignas(16) float product[AUDIO_BLOCK_SAMPLES];
+		for (int i = 0; i < numSamples; i += 4) {
+			(teensy::loadBlock4(&blocka->data[i]) * teensy::loadBlock4(&blockb->data[i]) * (1.f / 32768.f)).store(&product[i]);
+		}
+		teensy::floatToBlock(product, blockout->data);
+		return;
+	}
+
 	pa = (blocka->data);
 	pb = (blockb->data);
-	end = pa + AUDIO_BLOCK_SAMPLES;
+	end = pa + numSamples;
 
 	while (pa < end) {
 		*out++ = (int16_t) signed_saturate_rshift(int32_t (*pa++) * int32_t (*pb++), 16, 15);
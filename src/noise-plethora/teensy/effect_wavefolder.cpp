@@ -24,6 +24,7 @@
 #include "effect_wavefolder.hpp"
 
 void AudioEffectWaveFolder::update(const audio_block_t* blocka, const audio_block_t* blockb, audio_block_t* output) {
+	const int numSamples = teensy::blockSamples();
 
 	if (!blocka || !blockb || !output) {
 		return;
@@ -33,7 +34,7 @@ void AudioEffectWaveFolder::update(const audio_block_t* blocka, const audio_bloc
 	const int16_t* pb = blockb->data ;
 	int16_t* po = output->data ;
 
-	for (int i = 0 ; i < AUDIO_BLOCK_SAMPLES ; i++) {
+	for (int i = 0 ; i < numSamples ; i++) {
 		int32_t a12 = pa[i];
 		int32_t b12 = pb[i];
 
@@ -46,7 +46,8 @@
 
 
 void AudioFilterStateVariable::update_fixed(const int16_t* in, int16_t* lp, int16_t* bp, int16_t* hp) {
-	const int16_t* end = in + AUDIO_BLOCK_SAMPLES;
+	const int numSamples = teensy::blockSamples();
+	const int16_t* end = in + numSamples;
 	int32_t input, inputprev;
 	int32_t lowpass, bandpass, highpass;
 	int32_t lowpasstmp, bandpasstmp, highpasstmp;
@@ -83,7 +84,8 @@ void AudioFilterStateVariable::update_fixed(const int16_t* in, int16_t* lp, int1
 
 
 void AudioFilterStateVariable::update_variable(const int16_t* in, const int16_t* ctl, int16_t* lp, int16_t* bp, int16_t* hp) {
-	const int16_t* end = in + AUDIO_BLOCK_SAMPLES;
+	const int numSamples = teensy::blockSamples();
+	const int16_t* end = in + numSamples;
 	int32_t input, inputprev, control;
 	int32_t lowpass, bandpass, highpass;
 	int32_t lowpasstmp, bandpasstmp, highpasstmp;
@@ -161,3 +163,59 @@ void AudioFilterStateVariable::update_variable(const int16_t* in, const int16_t*
 	state_bandpass = bandpass;
 }
 
+
+// The same filter in float, with the state shared with the fixed point versions (in which signals have 12
+// fractional bits, and coefficients are scaled so MULT() gives 2 * fmult and damp / 2^30). The control input's
+// exponential is computed for the whole block first, 4 samples at a time.
+void AudioFilterStateVariable::update_float(const int16_t* in, const int16_t* ctl, int16_t* lp, int16_t* bp, int16_t* hp) {
+	const int numSamples = teensy::blockSamples();
+	using rack::simd::float_4;
+	const float stateScale = 1.f / 4096.f;
+	// MULT(fmult, x) is at most 2 * 5378279 * 2^8 / 2^31 times x
+	const float maxFmult = 2.f * 5378279.f * 256.f / 2147483648.f;
+
+	alignas(16) float fmult[AUDIO_BLOCK_SAMPLES];
+	if (ctl) {
+		// fcenter is the (unwarped) angular frequency of the centre, octaves per unit of control
+		const float fcenter = 2.f * setting_fcenter / 2147483648.f;
+		const float octavesPerUnit = setting_octavemult / (4096.f * 32768.f);
+		for (int i = 0; i < numSamples; i += 4) {
+			const float_4 octaves = teensy::loadBlock4(&ctl[i]) * octavesPerUnit;
+			rack::simd::fmin(fcenter * rack::dsp::exp2_taylor5(octaves), maxFmult).store(&fmult[i]);
+		}
+	}
+	else {
+		std::fill(fmult, &fmult[AUDIO_BLOCK_SAMPLES], 2.f * setting_fmult / 2147483648.f);
+	}
+	const float damp = setting_damp / 1073741824.f;
+
+	alignas(16) float lpOut[AUDIO_BLOCK_SAMPLES], bpOut[AUDIO_BLOCK_SAMPLES], hpOut[AUDIO_BLOCK_SAMPLES];
+	float inputprev = state_inputprev * stateScale;
+	float lowpass = state_lowpass * stateScale;
+	float bandpass = state_bandpass * stateScale;
+	float highpass;
+	for (int i = 0; i < numSamples; i++) {
+		const float input = in[i];
+		const float f = fmult[i];
+		lowpass = lowpass + f * bandpass;
+		highpass = (input + inputprev) * 0.5f - lowpass - damp * bandpass;
+		inputprev = input;
+		bandpass = bandpass + f * highpass;
+		const float lowpasstmp = lowpass;
+		const float bandpasstmp = bandpass;
+		const float highpasstmp = highpass;
+		lowpass = lowpass + f * bandpass;
+		highpass = input - lowpass - damp * bandpass;
+		bandpass = bandpass + f * highpass;
+		lpOut[i] = (lowpass + lowpasstmp) * 0.5f;
+		bpOut[i] = (bandpass + bandpasstmp) * 0.5f;
+		hpOut[i] = (highpass + highpasstmp) * 0.5f;
+	}
+	state_inputprev = inputprev * 4096.f;
+	state_lowpass = rack::math::clamp(lowpass * 4096.f, -2147483648.f, 2147483520.f);
+	state_bandpass = rack::math::clamp(bandpass * 4096.f, -2147483648.f, 2147483520.f);
+
+	teensy::floatToBlock(lpOut, lp);
+	teensy::floatToBlock(bpOut, bp);
+	teensy::floatToBlock(hpOut, hp);
+}
@@ -79,7 +79,14 @@ public:
 	void update(const audio_block_t* input_block, const audio_block_t* control_block,
 	            audio_block_t* lowpass_block, audio_block_t* bandpass_block, audio_block_t* highpass_block) {
 
-		if (control_block) {
+		if (teensy::fastFloat()) {
+			update_float(input_block->data,
+			             control_block ? control_block->data : nullptr,
+			             lowpass_block->data,
+			             bandpass_block->data,
+			             highpass_block->data);
+		}
+		else if (control_block) {
 			update_variable(input_block->data,
 			                control_block->data,
 			                lowpass_block->data,
@@ -98,6 +105,7 @@ public:
 private:
 	void update_fixed(const int16_t* in, int16_t* lp, int16_t* bp, int16_t* hp);
 	void update_variable(const int16_t* in, const int16_t* ctl, int16_t* lp, int16_t* bp, int16_t* hp);
+	void update_float(const int16_t* in, const int16_t* ctl, int16_t* lp, int16_t* bp, int16_t* hp);
 	int32_t setting_fcenter;
 	int32_t setting_fmult;
 	int32_t setting_octavemult;
@@ -31,7 +31,7 @@
 #define MULTI_UNITYGAIN 256
 
 static void applyGain(int16_t* data, int32_t mult) {
-	const int16_t* end = data + AUDIO_BLOCK_SAMPLES;
+	const int16_t* end = data + teensy::blockSamples();
 
 	do {
 		int32_t val = *data * mult;
@@ -40,7 +40,7 @@ static void applyGain(int16_t* data, int32_t mult) {
 }
 
 static void applyGainThenAdd(int16_t* dst, const int16_t* src, int32_t mult) {
-	const int16_t* end = dst + AUDIO_BLOCK_SAMPLES;
+	const int16_t* end = dst + teensy::blockSamples();
 
 	if (mult == MULTI_UNITYGAIN) {
 		do {
@@ -68,6 +68,10 @@ public:
 		if (!out) {
 			return;
 		}
+		else if (teensy::fastFloat()) {
+			update_float(in1, in2, in3, in4, out);
+			return;
+		}
 		else {
 			// zero buffer before processing
 			out->zeroAudioBlock();
@@ -97,6 +101,30 @@ public:
 		multiplier[channel] = gain * 256.0f; // TODO: proper roundoff?
 	}
 private:
+	// as update(), but summed in float, 8 samples at a time, and only saturated once all inputs are added
+	void update_float(const audio_block_t* in1, const audio_block_t* in2, const audio_block_t* in3, const audio_block_t* in4, audio_block_t* out) {
+		const int numSamples = teensy::blockSamples();
+		using rack::simd::float_4;
+		const audio_block_t* const in[4] = {in1, in2, in3, in4};
+		const int16_t* data[4];
+		float gains[4];
+		int numInputs = 0;
+		for (int channel = 0; channel < 4; channel++) {
+			if (in[channel]) {
+				data[numInputs] = in[channel]->data;
+				gains[numInputs++] = multiplier[channel] * (1.f / 256.f);
+			}
+		}
+		for (int i = 0; i < numSamples; i += 8) {
+			float_4 sum[2] = {};
+			for (int n = 0; n < numInputs; n++) {
+				sum[0] += teensy::loadBlock4(&data[n][i]) * gains[n];
+				sum[1] += teensy::loadBlock4(&data[n][i + 4]) * gains[n];
+			}
+			teensy::storeBlock8(sum[0], sum[1], &out->data[i]);
+		}
+	}
+
 	int16_t multiplier[4];	
 };
 
@@ -108,6 +136,7 @@ public:
 
 	// acts in place
 	void update(audio_block_t* block) {
+		const int numSamples = teensy::blockSamples();
 		if (!block)	{
 			return;
 		}
@@ -116,7 +145,7 @@ public:
 
 		if (mult == 0) {
 			// zero gain, discard any input and transmit nothing
-			memset(block->data, 0, sizeof(int16_t) * AUDIO_BLOCK_SAMPLES);
+			memset(block->data, 0, sizeof(int16_t) * numSamples);
 		}
 		else if (mult == MULTI_UNITYGAIN) {
 			// unity gain, pass input to output without any change
@@ -117,6 +117,7 @@ public:
 		return (float)m * (float)(1.0 / 2147418112.0);
 	}
 	void update(audio_block_t* block) {
+		const int numSamples = teensy::blockSamples();
 		uint32_t* p, *end, val;
 		int32_t count, t1, t2, t3, t4;
 
@@ -124,7 +125,7 @@ public:
 			return;
 		}
 		p = (uint32_t*)(block->data);
-		end = p + AUDIO_BLOCK_SAMPLES / 2;
+		end = p + numSamples / 2;
 
 		if (state == 0) {
 			// steady DC output, simply fill the buffer with fixed value
@@ -144,7 +145,7 @@ public:
 			// transitioning to a new DC level
 			//count = (target - magnitude) / increment;
 			count = substract_int32_then_divide_int32(target, magnitude, increment);
-			if (count >= AUDIO_BLOCK_SAMPLES) {
+			if (count >= numSamples) {
 				// this update will not reach the target
 				do {
 					magnitude += increment;
@@ -38,8 +38,6 @@
 
 #include "synth_pinknoise.hpp"
 
-int16_t AudioSynthNoisePink::instance_cnt = 0;
-
 // Let preprocessor and compiler calculate two lookup tables for 12-tap FIR Filter
 // with these coefficients: 1.190566, 0.162580, 0.002208, 0.025475, -0.001522,
 // 0.007322, 0.001774, 0.004529, -0.001561, 0.000776, -0.000486, 0.002017
@@ -75,6 +73,7 @@ const uint8_t AudioSynthNoisePink::pnmask[256] = {
 	      pfirb[lfsr >> 6 & 0x3F]    /* add 2nd half, also correts bias */
 
 void AudioSynthNoisePink::update(audio_block_t* block) {
+	const int numSamples = teensy::blockSamples();
 	uint32_t* p, *end;
 	int32_t n1, n2;
 	int32_t gain;
@@ -88,7 +87,7 @@ void AudioSynthNoisePink::update(audio_block_t* block) {
 	if (!block)
 		return;
 	p = (uint32_t*)(block->data);
-	end = p + AUDIO_BLOCK_SAMPLES / 2;
+	end = p + numSamples / 2;
 	taps = 0x46000001;
 	inc = pinc;
 	dec = pdec;
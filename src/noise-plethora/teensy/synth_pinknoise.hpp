@@ -31,7 +31,8 @@
 class AudioSynthNoisePink : public AudioStream {
 public:
 	AudioSynthNoisePink() : AudioStream(0) {
-		plfsr  = 0x5EED41F5 + instance_cnt++;
+		// (any non-zero value)
+		plfsr  = (int32_t) teensy::nextSeed() | 1;
 		paccu  = 0;
 		pncnt  = 0;
 		pinc   = 0x0CCC;
@@ -49,7 +50,6 @@ private:
 	static const uint8_t pnmask[256];
 	static const int32_t pfira[64];
 	static const int32_t pfirb[64];
-	static int16_t instance_cnt;
 	int32_t plfsr;		// linear feedback shift register
 	int32_t pinc;		// increment for all noise sources (bits)
 	int32_t pdec;		// decrement for all noise sources
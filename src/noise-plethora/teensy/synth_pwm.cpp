@@ -29,6 +29,7 @@
 
 
 void AudioSynthWaveformPWM::update(const audio_block_t* modinput, audio_block_t* block) {
+	const uint32_t numSamples = teensy::blockSamples();
 	uint32_t i;
 	int32_t out;
 
@@ -43,7 +44,7 @@ void AudioSynthWaveformPWM::update(const audio_block_t* modinput, audio_block_t*
 		const uint32_t _duration = duration;
 		uint32_t _elapsed = elapsed;
 		int32_t _magnitude = magnitude;
-		for (i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+		for (i = 0; i < numSamples; i++) {
 			_elapsed += 65536;
 			int32_t in = modinput->data[i];
 			if (_magnitude < 0)
@@ -70,7 +71,7 @@ void AudioSynthWaveformPWM::update(const audio_block_t* modinput, audio_block_t*
 
 	}
 	else {
-		for (i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+		for (i = 0; i < numSamples; i++) {
 			elapsed += 65536;
 			if (elapsed < duration) {
 				out = magnitude;
@@ -66,6 +66,7 @@ public:
 		magnitude = n * 65536.0f;
 	}
 	void update(audio_block_t* block) {
+		const uint32_t numSamples = teensy::blockSamples();
 		uint32_t i, ph, inc, index, scale;
 		int32_t val1, val2;
 
@@ -73,7 +74,7 @@ public:
 			if (block) {
 				ph = phase_accumulator;
 				inc = phase_increment;
-				for (i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+				for (i = 0; i < numSamples; i++) {
 					index = ph >> 24;
 					val1 = AudioWaveformSine[index];
 					val2 = AudioWaveformSine[index + 1];
@@ -87,7 +88,7 @@ public:
 				return;
 			}
 		}
-		phase_accumulator += phase_increment * AUDIO_BLOCK_SAMPLES;
+		phase_accumulator += phase_increment * numSamples;
 	}
 private:
 	uint32_t phase_accumulator;
@@ -115,6 +116,7 @@ public:
 		else if (freq > maxFrequency)
 			freq = maxFrequency;
 		phase_increment = freq * (4294967296.0f / APP->engine->getSampleRate());
+		frequencyRamp.set(phase_increment);
 	}
 	void phase(float angle) {
 		if (angle < 0.0f)
@@ -133,9 +135,11 @@ public:
 		else if (n > 1.0f)
 			n = 1.0f;
 		magnitude = n * 65536.0f;
+		magnitudeRamp.set(magnitude);
 	}
 
 	void update(const audio_block_t* modinput, audio_block_t* block) {
+		const uint32_t numSamples = teensy::blockSamples();
 
 		uint32_t i, ph, inc, index, scale;
 		int32_t val1, val2;
@@ -147,8 +151,15 @@ public:
 			// unable to allocate memory, so we'll send nothing
 			return;
 		}
+		if (teensy::fastFloat()) {
+			update_float(modinput, block);
+			return;
+		}
+		// (only the float path ramps)
+		frequencyRamp.advance(numSamples);
+		magnitudeRamp.advance(numSamples);
 		if (modinput) {
-			for (i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+			for (i = 0; i < numSamples; i++) {
 				index = ph >> 24;
 				val1 = AudioWaveformSine[index];
 				val2 = AudioWaveformSine[index + 1];
@@ -167,7 +178,7 @@ public:
 		else {
 			ph = phase_accumulator;
 			inc = phase_increment;
-			for (i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+			for (i = 0; i < numSamples; i++) {
 				index = ph >> 24;
 				val1 = AudioWaveformSine[index];
 				val2 = AudioWaveformSine[index + 1];
@@ -181,8 +192,50 @@ public:
 		phase_accumulator = ph;
 	}
 private:
+	// as update(), but with the modulated phase increments and the sine computed in float, 4 samples at a time, and
+	// with changes of frequency and amplitude ramped (see teensy::ParamRamp)
+	void update_float(const audio_block_t* modinput, audio_block_t* block) {
+		const int numSamples = teensy::blockSamples();
+		using rack::simd::float_4;
+		alignas(16) uint32_t phasedata[AUDIO_BLOCK_SAMPLES];
+		uint32_t ph = phase_accumulator;
+		const uint32_t inc = phase_increment;
+		const bool rampingFrequency = frequencyRamp.isRamping();
+		if (modinput) {
+			// -32768 = no phase increment, 32767 = double phase increment
+			alignas(16) float phstep[AUDIO_BLOCK_SAMPLES];
+			for (int i = 0; i < numSamples; i += 4) {
+				(1.f + teensy::loadBlock4(&modinput->data[i]) * (1.f / 32768.f)).store(&phstep[i]);
+			}
+			for (int i = 0; i < numSamples; i++) {
+				phasedata[i] = ph;
+				ph += (uint32_t)(phstep[i] * (rampingFrequency ? frequencyRamp.at(i) : inc));
+			}
+		}
+		else {
+			for (int i = 0; i < numSamples; i++) {
+				phasedata[i] = ph;
+				ph += rampingFrequency ? (uint32_t) frequencyRamp.at(i) : inc;
+			}
+		}
+		phase_accumulator = ph;
+		frequencyRamp.advance(numSamples);
+
+		alignas(16) float out[AUDIO_BLOCK_SAMPLES];
+		// the table peaks at 32767
+		const bool rampingMagnitude = magnitudeRamp.isRamping();
+		for (int i = 0; i < numSamples; i += 4) {
+			const float_4 m = rampingMagnitude ? magnitudeRamp.at4(i) : float_4((float) magnitude);
+			(teensy::sinPi(teensy::loadPhase4(&phasedata[i])) * (m * (32767.f / 65536.f))).store(&out[i]);
+		}
+		magnitudeRamp.advance(numSamples);
+		teensy::floatToBlock(out, block->data);
+	}
+
 	uint32_t phase_accumulator;
 	uint32_t phase_increment;
 	int32_t magnitude;
+	teensy::ParamRamp frequencyRamp; 	// of phase_increment
+	teensy::ParamRamp magnitudeRamp;
 };
 
@@ -81,6 +81,7 @@ public:
 	}
 
 	void update(audio_block_t* block) {
+		const uint32_t numSamples = teensy::blockSamples();
 
 		int16_t* bp, *end;
 		int32_t val1, val2;
@@ -90,19 +91,19 @@ public:
 
 		ph = phase_accumulator + phase_offset;
 		if (magnitude == 0) {
-			phase_accumulator += inc * AUDIO_BLOCK_SAMPLES;
+			phase_accumulator += inc * numSamples;
 			return;
 		}
 
 		if (!block) {
-			phase_accumulator += inc * AUDIO_BLOCK_SAMPLES;
+			phase_accumulator += inc * numSamples;
 			return;
 		}
 		bp = block->data;
 
 		switch (tone_type) {
 			case WAVEFORM_SINE:
-				for (i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+				for (i = 0; i < numSamples; i++) {
 					index = ph >> 24;
 					val1 = AudioWaveformSine[index];
 					val2 = AudioWaveformSine[index + 1];
@@ -116,11 +117,11 @@ public:
 
 			case WAVEFORM_ARBITRARY:
 				if (!arbdata) {
-					phase_accumulator += inc * AUDIO_BLOCK_SAMPLES;
+					phase_accumulator += inc * numSamples;
 					return;
 				}
 				// len = 256
-				for (i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+				for (i = 0; i < numSamples; i++) {
 					index = ph >> 24;
 					index2 = index + 1;
 					if (index2 >= 256)
@@ -137,7 +138,7 @@ public:
 
 			case WAVEFORM_SQUARE:
 				magnitude15 = signed_saturate_rshift(magnitude, 16, 1);
-				for (i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+				for (i = 0; i < numSamples; i++) {
 					if (ph & 0x80000000) {
 						*bp++ = -magnitude15;
 					}
@@ -149,21 +150,21 @@ public:
 				break;
 
 			case WAVEFORM_SAWTOOTH:
-				for (i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+				for (i = 0; i < numSamples; i++) {
 					*bp++ = signed_multiply_32x16t(magnitude, ph);
 					ph += inc;
 				}
 				break;
 
 			case WAVEFORM_SAWTOOTH_REVERSE:
-				for (i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+				for (i = 0; i < numSamples; i++) {
 					*bp++ = signed_multiply_32x16t(0xFFFFFFFFu - magnitude, ph);
 					ph += inc;
 				}
 				break;
 
 			case WAVEFORM_TRIANGLE:
-				for (i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+				for (i = 0; i < numSamples; i++) {
 					uint32_t phtop = ph >> 30;
 					if (phtop == 1 || phtop == 2) {
 						*bp++ = ((0xFFFF - (ph >> 15)) * magnitude) >> 16;
@@ -179,7 +180,7 @@ public:
 				do {
 					uint32_t rise = 0xFFFFFFFF / (pulse_width >> 16);
 					uint32_t fall = 0xFFFFFFFF / (0xFFFF - (pulse_width >> 16));
-					for (i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+					for (i = 0; i < numSamples; i++) {
 						if (ph < pulse_width / 2) {
 							uint32_t n = (ph >> 16) * rise;
 							*bp++ = ((n >> 16) * magnitude) >> 16;
@@ -199,7 +200,7 @@ public:
 
 			case WAVEFORM_PULSE:
 				magnitude15 = signed_saturate_rshift(magnitude, 16, 1);
-				for (i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+				for (i = 0; i < numSamples; i++) {
 					if (ph < pulse_width) {
 						*bp++ = magnitude15;
 					}
@@ -211,11 +212,11 @@ public:
 				break;
 
 			case WAVEFORM_SAMPLE_HOLD:
-				for (i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+				for (i = 0; i < numSamples; i++) {
 					*bp++ = sample;
 					uint32_t newph = ph + inc;
 					if (newph < ph) {
-						sample = teensy::random_teensy(magnitude) - (magnitude >> 1);
+						sample = random.below(magnitude) - (magnitude >> 1);
 					}
 					ph = newph;
 				}
@@ -225,7 +226,7 @@ public:
 
 		if (tone_offset) {
 			bp = block->data;
-			end = bp + AUDIO_BLOCK_SAMPLES;
+			end = bp + numSamples;
 			do {
 				val1 = *bp;
 				*bp++ = signed_saturate_rshift(val1 + tone_offset, 16, 0);
@@ -241,6 +242,7 @@ private:
 	uint32_t pulse_width;
 	const int16_t* arbdata;
 	int16_t  sample; // for WAVEFORM_SAMPLE_HOLD
+	teensy::Random random;
 	short    tone_type;
 	int16_t  tone_offset;
 };
@@ -268,6 +270,7 @@ public:
 		phase_increment = freq * (4294967296.0f / APP->engine->getSampleRate());
 		if (phase_increment > 0x7FFE0000u)
 			phase_increment = 0x7FFE0000;
+		frequencyRamp.set(phase_increment);
 	}
 	void amplitude(float n) {	// 0 to 1.0
 		if (n < 0) {
@@ -277,6 +280,7 @@ public:
 			n = 1.0f;
 		}
 		magnitude = n * 65536.0f;
+		magnitudeRamp.set(magnitude);
 	}
 	void offset(float n) {
 		if (n < -1.0f) {
@@ -321,6 +325,7 @@ public:
 	}
 
 	void update(audio_block_t* moddata, audio_block_t* shapedata, audio_block_t* block) {
+		const uint32_t numSamples = teensy::blockSamples();
 
 		int16_t* bp, *end;
 		int32_t val1, val2;
@@ -332,13 +337,21 @@ public:
 			return;
 		}
 
+		if (teensy::fastFloat() && hasFloatImplementation()) {
+			update_float(moddata, shapedata, block);
+			return;
+		}
+		// (only the float path ramps)
+		frequencyRamp.advance(numSamples);
+		magnitudeRamp.advance(numSamples);
+
 		// Pre-compute the phase angle for every output sample of this update
 		ph = phase_accumulator;
 		priorphase = phasedata[AUDIO_BLOCK_SAMPLES - 1];
 		if (moddata && modulation_type == 0) {
 			// Frequency Modulation
 			bp = moddata->data;
-			for (i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+			for (i = 0; i < numSamples; i++) {
 				int32_t n = (*bp++) * modulation_factor; // n is # of octaves to mod
 				int32_t ipart = n >> 27; // 4 integer bits
 				n &= 0x7FFFFFF;          // 27 fractional bits
@@ -376,7 +389,7 @@ public:
 		else if (moddata) {
 			// Phase Modulation
 			bp = moddata->data;
-			for (i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+			for (i = 0; i < numSamples; i++) {
 				// more than +/- 180 deg shift by 32 bit overflow of "n"
 				uint32_t n = ((uint32_t)(*bp++)) * modulation_factor;
 				phasedata[i] = ph + n;
@@ -385,7 +398,7 @@ public:
 		}
 		else {
 			// No Modulation Input
-			for (i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+			for (i = 0; i < numSamples; i++) {
 				phasedata[i] = ph;
 				ph += inc;
 			}
@@ -397,7 +410,7 @@ public:
 		// Now generate the output samples using the pre-computed phase angles
 		switch (tone_type) {
 			case WAVEFORM_SINE:
-				for (i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+				for (i = 0; i < numSamples; i++) {
 					ph = phasedata[i];
 					index = ph >> 24;
 					val1 = AudioWaveformSine[index];
@@ -415,7 +428,7 @@ public:
 					return;
 				}
 				// len = 256
-				for (i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+				for (i = 0; i < numSamples; i++) {
 					ph = phasedata[i];
 					index = ph >> 24;
 					index2 = index + 1;
@@ -433,7 +446,7 @@ public:
 			case WAVEFORM_PULSE:
 				if (shapedata) {
 					magnitude15 = signed_saturate_rshift(magnitude, 16, 1);
-					for (i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+					for (i = 0; i < numSamples; i++) {
 						uint32_t width = ((shapedata->data[i] + 0x8000) & 0xFFFF) << 16;
 						if (phasedata[i] < width) {
 							*bp++ = magnitude15;
@@ -447,7 +460,7 @@ public:
 			// fall through
 			case WAVEFORM_SQUARE:
 				magnitude15 = signed_saturate_rshift(magnitude, 16, 1);
-				for (i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+				for (i = 0; i < numSamples; i++) {
 					if (phasedata[i] & 0x80000000) {
 						*bp++ = -magnitude15;
 					}
@@ -458,20 +471,20 @@ public:
 				break;
 
 			case WAVEFORM_SAWTOOTH:
-				for (i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+				for (i = 0; i < numSamples; i++) {
 					*bp++ = signed_multiply_32x16t(magnitude, phasedata[i]);
 				}
 				break;
 
 			case WAVEFORM_SAWTOOTH_REVERSE:
-				for (i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+				for (i = 0; i < numSamples; i++) {
 					*bp++ = signed_multiply_32x16t(0xFFFFFFFFu - magnitude, phasedata[i]);
 				}
 				break;
 
 			case WAVEFORM_TRIANGLE_VARIABLE:
 				if (shapedata) {
-					for (i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+					for (i = 0; i < numSamples; i++) {
 						uint32_t width = (shapedata->data[i] + 0x8000) & 0xFFFF;
 						uint32_t rise = 0xFFFFFFFF / width;
 						uint32_t fall = 0xFFFFFFFF / (0xFFFF - width);
@@ -496,7 +509,7 @@ public:
 				} // else fall through to orginary triangle without shape modulation
 			// fall through
 			case WAVEFORM_TRIANGLE:
-				for (i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+				for (i = 0; i < numSamples; i++) {
 					ph = phasedata[i];
 					uint32_t phtop = ph >> 30;
 					if (phtop == 1 || phtop == 2) {
@@ -508,10 +521,10 @@ public:
 				}
 				break;
 			case WAVEFORM_SAMPLE_HOLD:
-				for (i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+				for (i = 0; i < numSamples; i++) {
 					ph = phasedata[i];
 					if (ph < priorphase) { // does not work for phase modulation
-						sample = teensy::random_teensy(magnitude) - (magnitude >> 1);
+						sample = random.below(magnitude) - (magnitude >> 1);
 					}
 					priorphase = ph;
 					*bp++ = sample;
@@ -521,7 +534,7 @@ public:
 
 		if (tone_offset) {
 			bp = block->data;
-			end = bp + AUDIO_BLOCK_SAMPLES;
+			end = bp + numSamples;
 			do {
 				val1 = *bp;
 				*bp++ = signed_saturate_rshift(val1 + tone_offset, 16, 0);
@@ -537,14 +550,138 @@ public:
 
 private:
 
+	bool hasFloatImplementation() const {
+		return tone_type == WAVEFORM_SINE || tone_type == WAVEFORM_SAWTOOTH || tone_type == WAVEFORM_SAWTOOTH_REVERSE
+		       || tone_type == WAVEFORM_SQUARE || tone_type == WAVEFORM_PULSE || tone_type == WAVEFORM_TRIANGLE;
+	}
+
+	// as update(), but with the exponential FM and the waveshapes computed in float, 4 samples at a time (the
+	// phase is still accumulated in 32 bits, so is shared with the hardware exact path), and with changes of
+	// frequency and amplitude ramped (see teensy::ParamRamp)
+	void update_float(audio_block_t* moddata, audio_block_t* shapedata, audio_block_t* block) {
+		const int numSamples = teensy::blockSamples();
+		using rack::simd::float_4;
+		using rack::simd::int32_4;
+		const uint32_t inc = phase_increment;
+		const uint32_t startPhase = phase_accumulator;
+		uint32_t ph = startPhase;
+		const bool rampingFrequency = frequencyRamp.isRamping();
+
+		if (moddata && modulation_type == 0) {
+			// Frequency Modulation: 2^(octaves) for a vector of samples, then the (serial) phase accumulation
+			alignas(16) float phstep[AUDIO_BLOCK_SAMPLES];
+			const float octavesPerUnit = modulation_factor / (4096.f * 32768.f);
+			for (int i = 0; i < numSamples; i += 4) {
+				const float_4 scale = rack::dsp::exp2_taylor5(teensy::loadBlock4(&moddata->data[i]) * octavesPerUnit);
+				const float_4 increment = rampingFrequency ? frequencyRamp.at4(i) : float_4((float) inc);
+				rack::simd::fmin(scale * increment, (float) 0x7FFE0000).store(&phstep[i]);
+			}
+			for (int i = 0; i < numSamples; i++) {
+				ph += (uint32_t) phstep[i];
+				phasedata[i] = ph;
+			}
+		}
+		else if (moddata) {
+			// Phase Modulation
+			for (int i = 0; i < numSamples; i++) {
+				phasedata[i] = ph + ((uint32_t) moddata->data[i]) * modulation_factor;
+				ph += rampingFrequency ? (uint32_t) frequencyRamp.at(i) : inc;
+			}
+		}
+		else if (rampingFrequency) {
+			for (int i = 0; i < numSamples; i++) {
+				phasedata[i] = ph;
+				ph += (uint32_t) frequencyRamp.at(i);
+			}
+		}
+		else {
+			ph += inc * numSamples;
+		}
+		phase_accumulator = ph;
+		frequencyRamp.advance(numSamples);
+
+		// shape(x, m, i) gives 4 samples from i, for phases x in [-1, 1) (0 at the start of the cycle) and magnitudes
+		// m; with neither modulation nor a ramp, the phases are generated a vector at a time rather than read from
+		// phasedata
+		const bool usePhaseData = moddata || rampingFrequency;
+		const bool rampingMagnitude = magnitudeRamp.isRamping();
+		const float offset = tone_offset;
+		auto render = [&](auto shape) {
+			int32_4 phase(startPhase, startPhase + inc, startPhase + 2 * inc, startPhase + 3 * inc);
+			const int32_4 phaseStep = (int32_t)(4 * inc);
+			for (int i = 0; i < numSamples; i += 8) {
+				float_4 x[2], m[2];
+				for (int j = 0; j < 2; j++) {
+					if (usePhaseData) {
+						x[j] = teensy::loadPhase4(&phasedata[i + 4 * j]);
+					}
+					else {
+						x[j] = teensy::phaseToFloat(phase);
+						phase += phaseStep;
+					}
+					m[j] = rampingMagnitude ? magnitudeRamp.at4(i + 4 * j) : float_4((float) magnitude);
+				}
+				teensy::storeBlock8(shape(x[0], m[0], i) + offset, shape(x[1], m[1], i + 4) + offset, &block->data[i]);
+			}
+		};
+
+		switch (tone_type) {
+			case WAVEFORM_SINE: {
+				render([&](float_4 x, float_4 m, int i) {
+					// the table peaks at 32767
+					return teensy::sinPi(x) * (m * (32767.f / 65536.f));
+				});
+				break;
+			}
+			case WAVEFORM_SAWTOOTH:
+				render([&](float_4 x, float_4 m, int i) {
+					return x * (m * 0.5f);
+				});
+				break;
+			case WAVEFORM_SAWTOOTH_REVERSE:
+				render([&](float_4 x, float_4 m, int i) {
+					return x * -(m * 0.5f);
+				});
+				break;
+			case WAVEFORM_TRIANGLE:
+				render([&](float_4 x, float_4 m, int i) {
+					const float_4 tri = rack::simd::ifelse(rack::simd::abs(x) < 0.5f, 2.f * x, rack::simd::ifelse(x < 0.f, -2.f, 2.f) - 2.f * x);
+					return tri * (m * 0.5f);
+				});
+				break;
+			case WAVEFORM_PULSE:
+				if (shapedata) {
+					// width from the shape input, compared with the phase measured from the half cycle point (so it
+					// increases over [-1, 1) through the cycle)
+					render([&](float_4 x, float_4 m, int i) {
+						const float_4 width = teensy::loadBlock4(&shapedata->data[i]) * (1.f / 32768.f);
+						const float_4 amplitude15 = rack::simd::fmin(m * 0.5f, 32767.f);
+						return rack::simd::ifelse(rack::simd::ifelse(x < 0.f, x + 1.f, x - 1.f) < width, amplitude15, -amplitude15);
+					});
+					break;
+				}
+			// fall through
+			default:
+				render([&](float_4 x, float_4 m, int i) {
+					const float_4 amplitude15 = rack::simd::fmin(m * 0.5f, 32767.f);
+					return rack::simd::ifelse(x < 0.f, -amplitude15, amplitude15);
+				});
+				break;
+		}
+		magnitudeRamp.advance(numSamples);
+	}
+
 	uint32_t phase_accumulator;
 	uint32_t phase_increment;
 	uint32_t modulation_factor;
 	int32_t  magnitude;
 	const int16_t* arbdata;
 	uint32_t phasedata[AUDIO_BLOCK_SAMPLES];
+	teensy::ParamRamp frequencyRamp; 	// of phase_increment
+	teensy::ParamRamp magnitudeRamp;
 
 	int16_t  sample; // for WAVEFORM_SAMPLE_HOLD
+	teensy::Random random;
 	int16_t  tone_offset;
 	uint8_t  tone_type;
 	uint8_t  modulation_type;
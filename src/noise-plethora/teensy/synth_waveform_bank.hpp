@@ -0,0 +1,447 @@
+#pragma once
+
+#include "audio_core.hpp"
+
+/**
+ * N oscillators of one waveform, held as arrays (phase, increment, magnitude) rather than as N
+ * AudioSynthWaveformModulated objects, and rendered together. This replaces the cluster programs' banks of
+ * oscillators and the trees of unity gain AudioMixer4s summing them: update() adds every oscillator straight
+ * into one output block. Oscillators can share a frequency modulation input and a pulse width input, or
+ * each be frequency modulated by the matching oscillator of another bank.
+ *
+ * In both modes the oscillators are summed as by a tree of AudioMixer4s: in groups of four, saturated, then
+ * the groups' sums (the clusters drive their mixers well into clipping, which is part of their sound). With
+ * teensy::FAST_FLOAT, the lanes of each vector are four oscillators, i.e. one group, all advanced a sample at
+ * a time, so frequency modulation is vectorised too (unmodulated banks are instead rendered four samples at a
+ * time). Otherwise, each oscillator is computed exactly as AudioSynthWaveformModulated would, and saturated
+ * after each addition.
+ *
+ * Supports the sine, sawtooth (and reverse), square, pulse and triangle waveforms (variable triangle only
+ * without a shape input, where it's a plain triangle).
+ */
+template <int N>
+class AudioSynthWaveformBank : public AudioStream {
+public:
+	static const int NUM_VECTORS = (N + 3) / 4;
+	// oscillators beyond N are padding, which stay silent
+	static const int NUM_LANES = 4 * NUM_VECTORS;
+
+	// a block of samples for each oscillator, interleaved
+	struct Block {
+		alignas(16) int16_t data[AUDIO_BLOCK_SAMPLES][NUM_LANES] = {};
+	};
+
+	AudioSynthWaveformBank() : AudioStream(2) {
+		for (int i = 0; i < NUM_LANES; i++) {
+			phase_accumulator[i] = 0;
+			phase_increment[i] = 0;
+			magnitude[i] = 0;
+		}
+	}
+
+	void begin(float t_amp, short t_type) {
+		assert(t_type == WAVEFORM_SINE || t_type == WAVEFORM_SAWTOOTH || t_type == WAVEFORM_SAWTOOTH_REVERSE || t_type == WAVEFORM_SQUARE
+		       || t_type == WAVEFORM_PULSE || t_type == WAVEFORM_TRIANGLE || t_type == WAVEFORM_TRIANGLE_VARIABLE);
+		tone_type = (t_type == WAVEFORM_TRIANGLE_VARIABLE) ? WAVEFORM_TRIANGLE : t_type;
+		for (int i = 0; i < N; i++) {
+			amplitude(i, t_amp);
+		}
+	}
+
+	void frequency(int i, float freq) {
+		// as AudioSynthWaveformModulated
+		const float maxFrequency = std::min(AUDIO_SAMPLE_RATE_EXACT, APP->engine->getSampleRate()) / 2.0f;
+		if (freq < 0.0f) {
+			freq = 0.0;
+		}
+		else if (freq > maxFrequency) {
+			freq = maxFrequency;
+		}
+		phase_increment[i] = freq * (4294967296.0f / APP->engine->getSampleRate());
+		if (phase_increment[i] > 0x7FFE0000u)
+			phase_increment[i] = 0x7FFE0000;
+		frequencyRamps[i].set(phase_increment[i]);
+	}
+
+	void amplitude(int i, float n) {	// 0 to 1.0
+		if (n < 0) {
+			n = 0;
+		}
+		else if (n > 1.0f) {
+			n = 1.0f;
+		}
+		magnitude[i] = n * 65536.0f;
+	}
+
+	// depth of the frequency modulation input, for all oscillators
+	void frequencyModulation(float octaves) {
+		if (octaves > 12.0f) {
+			octaves = 12.0f;
+		}
+		else if (octaves < 0.1f) {
+			octaves = 0.1f;
+		}
+		modulation_factor = octaves * 4096.0f;
+	}
+
+	/** Sum of all oscillators, with optional frequency modulation and pulse width inputs shared by all */
+	void update(const audio_block_t* moddata, const audio_block_t* shapedata, audio_block_t* out) {
+		if (!out) {
+			return;
+		}
+		render(moddata, nullptr, shapedata, out, nullptr);
+	}
+
+	/** Sum of all oscillators, each frequency modulated by its own input */
+	void update(const Block& moddata, audio_block_t* out) {
+		if (!out) {
+			return;
+		}
+		render(nullptr, &moddata, nullptr, out, nullptr);
+	}
+
+	/** Each oscillator separately (e.g. to modulate another bank) */
+	void update(Block& out) {
+		render(nullptr, nullptr, nullptr, nullptr, &out);
+	}
+
+private:
+	void render(const audio_block_t* sharedMod, const Block* mod, const audio_block_t* shapedata, audio_block_t* sum, Block* each) {
+		if (!teensy::fastFloat()) {
+			render_exact(sharedMod, mod, shapedata, sum, each);
+		}
+		else {
+			render_float_shape(sharedMod, mod, shapedata, sum, each);
+		}
+		// (only the float paths ramp)
+		for (int i = 0; i < N; i++) {
+			frequencyRamps[i].advance(teensy::blockSamples());
+		}
+	}
+
+	void render_float_shape(const audio_block_t* sharedMod, const Block* mod, const audio_block_t* shapedata, audio_block_t* sum, Block* each) {
+		using rack::simd::float_4;
+		bool rampingFrequency = false;
+		for (int i = 0; i < N; i++) {
+			rampingFrequency |= frequencyRamps[i].isRamping();
+		}
+
+		// shape(x, width) for phases x in [-1, 1) (0 at the start of the cycle), and pulse widths in [-1, 1)
+		auto renderFloat = [&](auto shape) {
+			if (sharedMod || mod || each || rampingFrequency) {
+				render_float(sharedMod, mod, shapedata, sum, each, rampingFrequency, shape);
+			}
+			else {
+				render_float_unmodulated(shapedata, sum, shape);
+			}
+		};
+		switch (tone_type) {
+			case WAVEFORM_SINE:
+				renderFloat([](float_4 x, float_4 width) {
+					return teensy::sinPi(x);
+				});
+				break;
+			case WAVEFORM_SAWTOOTH:
+				renderFloat([](float_4 x, float_4 width) {
+					return x;
+				});
+				break;
+			case WAVEFORM_SAWTOOTH_REVERSE:
+				renderFloat([](float_4 x, float_4 width) {
+					return -x;
+				});
+				break;
+			case WAVEFORM_TRIANGLE:
+				renderFloat([](float_4 x, float_4 width) {
+					return rack::simd::ifelse(rack::simd::abs(x) < 0.5f, 2.f * x, rack::simd::ifelse(x < 0.f, -2.f, 2.f) - 2.f * x);
+				});
+				break;
+			case WAVEFORM_PULSE:
+				if (shapedata) {
+					// width compared with the phase measured from the half cycle point (see AudioSynthWaveformModulated)
+					renderFloat([](float_4 x, float_4 width) {
+						return rack::simd::ifelse(rack::simd::ifelse(x < 0.f, x + 1.f, x - 1.f) < width, 1.f, -1.f);
+					});
+					break;
+				}
+			// fall through
+			default:
+				renderFloat([](float_4 x, float_4 width) {
+					return rack::simd::ifelse(x < 0.f, -1.f, 1.f);
+				});
+				break;
+		}
+	}
+
+	// gain applied to each oscillator's shape (in [-1, 1]) to give the same level as the fixed point waveforms
+	float getGain(int i) const {
+		switch (tone_type) {
+			// the sine table peaks at 32767
+			case WAVEFORM_SINE: return magnitude[i] * (32767.f / 65536.f);
+			case WAVEFORM_SQUARE:
+			case WAVEFORM_PULSE: return std::min(magnitude[i] * 0.5f, 32767.f);
+			default: return magnitude[i] * 0.5f;
+		}
+	}
+
+	// lanes are oscillators, phases are read then advanced without modulation, or advanced then read with it
+	// (as AudioSynthWaveformModulated); while any oscillator's frequency is ramping (see teensy::ParamRamp), every
+	// lane's increment is taken from its ramp
+	template <typename Shape>
+	void render_float(const audio_block_t* sharedMod, const Block* mod, const audio_block_t* shapedata, audio_block_t* sum, Block* each,
+	                  bool rampingFrequency, Shape shape) {
+		const int numSamples = teensy::blockSamples();
+		using rack::simd::float_4;
+		using rack::simd::int32_4;
+
+		int32_4 phase[NUM_VECTORS], increment[NUM_VECTORS];
+		float_4 floatIncrement[NUM_VECTORS], gain[NUM_VECTORS];
+		// each lane's ramp, as ParamRamp::at()
+		float_4 rampValue[NUM_VECTORS], rampStep[NUM_VECTORS], rampRemaining[NUM_VECTORS], rampTarget[NUM_VECTORS];
+		for (int v = 0; v < NUM_VECTORS; v++) {
+			phase[v] = int32_4::load((const int32_t*) &phase_accumulator[4 * v]);
+			increment[v] = int32_4::load((const int32_t*) &phase_increment[4 * v]);
+			floatIncrement[v] = float_4(phase_increment[4 * v], phase_increment[4 * v + 1], phase_increment[4 * v + 2], phase_increment[4 * v + 3]);
+			gain[v] = float_4(getGain(4 * v), getGain(4 * v + 1), getGain(4 * v + 2), getGain(4 * v + 3));
+			for (int j = 0; j < 4; j++) {
+				const teensy::ParamRamp& ramp = frequencyRamps[4 * v + j];
+				rampValue[v][j] = ramp.value;
+				rampStep[v][j] = ramp.step;
+				rampRemaining[v][j] = ramp.remaining;
+				rampTarget[v][j] = ramp.target;
+			}
+		}
+		const float octavesPerUnit = modulation_factor / (4096.f * 32768.f);
+		const float maxStep = 0x7FFE0000;
+
+		alignas(16) float out[AUDIO_BLOCK_SAMPLES];
+		for (int i = 0; i < numSamples; i++) {
+			const float sharedScale = sharedMod ? rack::dsp::exp2_taylor5(sharedMod->data[i] * octavesPerUnit) : 1.f;
+			const float_4 width = shapedata ? shapedata->data[i] * (1.f / 32768.f) : 0.f;
+			float_4 y[NUM_VECTORS];
+			for (int v = 0; v < NUM_VECTORS; v++) {
+				const float_4 rampIncrement = rampingFrequency ? rack::simd::ifelse(float_4(i) < rampRemaining[v], rampValue[v] + rampStep[v] * i,
+				                              rampTarget[v]) : floatIncrement[v];
+				int32_4 ph;
+				if (sharedMod || mod) {
+					const float_4 scale = mod ? rack::dsp::exp2_taylor5(teensy::loadBlock4(&mod->data[i][4 * v]) * octavesPerUnit) : sharedScale;
+					phase[v] += int32_4(rack::simd::fmin(rampIncrement * scale, maxStep));
+					ph = phase[v];
+				}
+				else {
+					ph = phase[v];
+					phase[v] += rampingFrequency ? int32_4(rampIncrement) : increment[v];
+				}
+				y[v] = shape(teensy::phaseToFloat(ph), width) * gain[v];
+				if (each) {
+					teensy::storeBlock4(y[v], &each->data[i][4 * v]);
+				}
+			}
+			if (sum) {
+				out[i] = groupSum(y);
+			}
+		}
+
+		for (int v = 0; v < NUM_VECTORS; v++) {
+			phase[v].store((int32_t*) &phase_accumulator[4 * v]);
+		}
+		if (sum) {
+			teensy::floatToBlock(out, sum->data);
+		}
+	}
+
+	// without modulation or separate outputs, lanes are instead four samples of one oscillator (as
+	// AudioSynthWaveformModulated), and each group of four oscillators is summed then saturated a vector at a time
+	template <typename Shape>
+	void render_float_unmodulated(const audio_block_t* shapedata, audio_block_t* sum, Shape shape) {
+		const int numSamples = teensy::blockSamples();
+		using rack::simd::float_4;
+		using rack::simd::int32_4;
+
+		alignas(16) float out[AUDIO_BLOCK_SAMPLES] = {};
+		for (int g = 0; g < N; g += 4) {
+			alignas(16) float group[AUDIO_BLOCK_SAMPLES] = {};
+			for (int o = g; o < std::min(g + 4, N); o++) {
+				const uint32_t ph = phase_accumulator[o];
+				const uint32_t inc = phase_increment[o];
+				const float gain = getGain(o);
+				int32_4 phase(ph, ph + inc, ph + 2 * inc, ph + 3 * inc);
+				const int32_4 phaseStep = (int32_t)(4 * inc);
+				for (int i = 0; i < numSamples; i += 4) {
+					const float_4 width = shapedata ? teensy::loadBlock4(&shapedata->data[i]) * (1.f / 32768.f) : 0.f;
+					(float_4::load(&group[i]) + shape(teensy::phaseToFloat(phase), width) * gain).store(&group[i]);
+					phase += phaseStep;
+				}
+				phase_accumulator[o] = ph + inc * numSamples;
+			}
+			for (int i = 0; i < numSamples; i += 4) {
+				(float_4::load(&out[i]) + rack::simd::clamp(float_4::load(&group[i]), -32768.f, 32767.f)).store(&out[i]);
+			}
+		}
+		teensy::floatToBlock(out, sum->data);
+	}
+
+	// sum of the (saturated) sums of each vector's lanes, transposed four vectors at a time
+	static float groupSum(rack::simd::float_4* y) {
+		using rack::simd::float_4;
+		float_4 total = 0.f;
+		for (int v = 0; v < NUM_VECTORS; v += 4) {
+			float_4 a = y[v];
+			float_4 b = (v + 1 < NUM_VECTORS) ? y[v + 1] : 0.f;
+			float_4 c = (v + 2 < NUM_VECTORS) ? y[v + 2] : 0.f;
+			float_4 d = (v + 3 < NUM_VECTORS) ? y[v + 3] : 0.f;
+			_MM_TRANSPOSE4_PS(a.v, b.v, c.v, d.v);
+			total += rack::simd::clamp(a + b + c + d, -32768.f, 32767.f);
+		}
+		return total[0] + total[1] + total[2] + total[3];
+	}
+
+	// the fixed point maths of AudioSynthWaveformModulated (exp2 algorithm by Laurent de Soras), as a phase step
+	// multiplier with 16 fractional bits
+	static uint32_t exp2Scale(int16_t mod, uint32_t factor) {
+		int32_t n = mod * factor;
+		int32_t ipart = n >> 27;
+		n &= 0x7FFFFFF;
+		n = (n + 134217728) << 3;
+		n = multiply_32x32_rshift32_rounded(n, n);
+		n = multiply_32x32_rshift32_rounded(n, 715827883) << 3;
+		n = n + 715827882;
+		return n >> (14 - ipart);
+	}
+
+	static uint32_t modulatedStep(uint32_t inc, uint32_t scale) {
+		const uint64_t phstep = (uint64_t) inc * scale;
+		return ((phstep >> 32) < 0x7FFE) ? (uint32_t)(phstep >> 16) : 0x7FFE0000;
+	}
+
+	void render_exact(const audio_block_t* sharedMod, const Block* mod, const audio_block_t* shapedata, audio_block_t* sum, Block* each) {
+		const int numSamples = teensy::blockSamples();
+		uint32_t sharedScale[AUDIO_BLOCK_SAMPLES];
+		if (sharedMod) {
+			for (int i = 0; i < numSamples; i++) {
+				sharedScale[i] = exp2Scale(sharedMod->data[i], modulation_factor);
+			}
+		}
+
+		int16_t group[AUDIO_BLOCK_SAMPLES] = {};
+		if (sum) {
+			sum->zeroAudioBlock();
+		}
+		for (int o = 0; o < N; o++) {
+			uint32_t phasedata[AUDIO_BLOCK_SAMPLES];
+			uint32_t ph = phase_accumulator[o];
+			const uint32_t inc = phase_increment[o];
+			if (mod) {
+				for (int i = 0; i < numSamples; i++) {
+					ph += modulatedStep(inc, exp2Scale(mod->data[i][o], modulation_factor));
+					phasedata[i] = ph;
+				}
+			}
+			else if (sharedMod) {
+				for (int i = 0; i < numSamples; i++) {
+					ph += modulatedStep(inc, sharedScale[i]);
+					phasedata[i] = ph;
+				}
+			}
+			else {
+				for (int i = 0; i < numSamples; i++) {
+					phasedata[i] = ph;
+					ph += inc;
+				}
+			}
+			phase_accumulator[o] = ph;
+
+			if (each) {
+				render_exact_shape(phasedata, magnitude[o], shapedata, &each->data[0][o], NUM_LANES);
+			}
+			if (sum) {
+				int16_t out[AUDIO_BLOCK_SAMPLES];
+				render_exact_shape(phasedata, magnitude[o], shapedata, out, 1);
+				// AudioMixer4 for each group of 4, then one for the groups
+				if (o % 4 == 0) {
+					std::fill(group, &group[AUDIO_BLOCK_SAMPLES], 0);
+				}
+				for (int i = 0; i < numSamples; i++) {
+					group[i] = signed_saturate_rshift(group[i] + out[i], 16, 0);
+				}
+				if (o % 4 == 3 || o == N - 1) {
+					for (int i = 0; i < numSamples; i++) {
+						sum->data[i] = signed_saturate_rshift(sum->data[i] + group[i], 16, 0);
+					}
+				}
+			}
+		}
+	}
+
+	// bp[i * stride] for each sample i
+	void render_exact_shape(const uint32_t* phasedata, int32_t magnitude, const audio_block_t* shapedata, int16_t* bp, int stride) const {
+		const int numSamples = teensy::blockSamples();
+		int32_t val1, val2;
+		uint32_t ph, index, scale;
+		int16_t magnitude15;
+
+		switch (tone_type) {
+			case WAVEFORM_SINE:
+				for (int i = 0; i < numSamples; i++) {
+					ph = phasedata[i];
+					index = ph >> 24;
+					val1 = AudioWaveformSine[index];
+					val2 = AudioWaveformSine[index + 1];
+					scale = (ph >> 8) & 0xFFFF;
+					val2 *= scale;
+					val1 *= 0x10000 - scale;
+					bp[i * stride] = multiply_32x32_rshift32(val1 + val2, magnitude);
+				}
+				break;
+
+			case WAVEFORM_PULSE:
+				if (shapedata) {
+					magnitude15 = signed_saturate_rshift(magnitude, 16, 1);
+					for (int i = 0; i < numSamples; i++) {
+						uint32_t width = ((shapedata->data[i] + 0x8000) & 0xFFFF) << 16;
+						bp[i * stride] = (phasedata[i] < width) ? magnitude15 : -magnitude15;
+					}
+					break;
+				}
+			// fall through
+			case WAVEFORM_SQUARE:
+				magnitude15 = signed_saturate_rshift(magnitude, 16, 1);
+				for (int i = 0; i < numSamples; i++) {
+					bp[i * stride] = (phasedata[i] & 0x80000000) ? -magnitude15 : magnitude15;
+				}
+				break;
+
+			case WAVEFORM_SAWTOOTH:
+				for (int i = 0; i < numSamples; i++) {
+					bp[i * stride] = signed_multiply_32x16t(magnitude, phasedata[i]);
+				}
+				break;
+
+			case WAVEFORM_SAWTOOTH_REVERSE:
+				for (int i = 0; i < numSamples; i++) {
+					bp[i * stride] = signed_multiply_32x16t(0xFFFFFFFFu - magnitude, phasedata[i]);
+				}
+				break;
+
+			case WAVEFORM_TRIANGLE:
+				for (int i = 0; i < numSamples; i++) {
+					ph = phasedata[i];
+					uint32_t phtop = ph >> 30;
+					if (phtop == 1 || phtop == 2) {
+						bp[i * stride] = ((0xFFFF - (ph >> 15)) * magnitude) >> 16;
+					}
+					else {
+						bp[i * stride] = (((int32_t)ph >> 15) * magnitude) >> 16;
+					}
+				}
+				break;
+		}
+	}
+
+	alignas(16) uint32_t phase_accumulator[NUM_LANES];
+	alignas(16) uint32_t phase_increment[NUM_LANES];
+	int32_t magnitude[NUM_LANES];
+	teensy::ParamRamp frequencyRamps[NUM_LANES]; 	// of phase_increment
+	uint32_t modulation_factor = 32768;
+	short tone_type = WAVEFORM_SINE;
+};
@@ -27,45 +27,21 @@
 
 #include "synth_whitenoise.hpp"
 
-// Park-Miller-Carta Pseudo-Random Number Generator
-// http://www.firstpr.com.au/dsp/rand31/
+// (the Teensy uses Park-Miller-Carta, here it's the per-instance teensy::Random, eight samples at a time)
 
 void AudioSynthNoiseWhite::update(audio_block_t* block) {
-	uint32_t* p, *end;
-	int32_t n1, n2, gain;
-	uint32_t lo, hi;
+	const int numSamples = teensy::blockSamples();
 
-	gain = level;
-	if (gain == 0)
+	if (level == 0)
 		return;
 
 	if (!block)
 		return;
-	p = (uint32_t*)(block->data);
-	end = p + AUDIO_BLOCK_SAMPLES / 2;
-	lo = seed;
-	do {
-		uint32_t val1;
-
-		hi = 16807 * (lo >> 16);
-		lo = 16807 * (lo & 0xFFFF);
-		lo += (hi & 0x7FFF) << 16;
-		lo += hi >> 15;
-		lo = (lo & 0x7FFFFFFF) + (lo >> 31);
-		n1 = signed_multiply_32x16b(gain, lo);
-		hi = 16807 * (lo >> 16);
-		lo = 16807 * (lo & 0xFFFF);
-		lo += (hi & 0x7FFF) << 16;
-		lo += hi >> 15;
-		lo = (lo & 0x7FFFFFFF) + (lo >> 31);
-		n2 = signed_multiply_32x16b(gain, lo);
-		val1 = pack_16b_16b(n2, n1);
-		*p++ = val1;
-
-	} while (p < end);
-	seed = lo;
+	// the upper 16 bits of each value, as signed samples
+	const float gain = level * (1.f / 65536.f);
+	for (int i = 0; i < numSamples; i += 8) {
+		const rack::simd::float_4 a(_mm_cvtepi32_ps(_mm_srai_epi32(random.next4(), 16)));
+		const rack::simd::float_4 b(_mm_cvtepi32_ps(_mm_srai_epi32(random.next4(), 16)));
+		teensy::storeBlock8(a * gain, b * gain, &block->data[i]);
+	}
 }
-
-uint16_t AudioSynthNoiseWhite::instance_count = 0;
-
-